@@ -93,6 +93,86 @@ C64Component::save(u8 *buffer)
     return result;
 }
 
+isize
+C64Component::deltaSize()
+{
+    isize result = _deltaSize();
+    for (C64Component *c : subComponents) { result += c->deltaSize(); }
+    return result;
+}
+
+isize
+C64Component::loadDelta(const u8 *buffer, const u8 *end)
+{
+    const u8 *ptr = buffer;
+
+    // Call delegation method
+    ptr += willLoadFromBuffer(ptr);
+
+    // Load internal state of all subcomponents
+    for (C64Component *c : subComponents) {
+        ptr += c->loadDelta(ptr, end);
+    }
+
+    // Load internal state of this component
+    ptr += _loadDelta(ptr, end);
+
+    // Call delegation method
+    ptr += didLoadFromBuffer(ptr);
+    isize result = (isize)(ptr - buffer);
+    
+    trace(SNP_DEBUG, "Loaded %zd delta bytes\n", result);
+    return result;
+}
+
+isize
+C64Component::_loadDelta(const u8 *buffer, const u8 *end)
+{
+    if (_size() > end - buffer) throw VC64Error(ERROR_SNP_CORRUPTED);
+    return _load(buffer);
+}
+
+isize
+C64Component::saveDelta(u8 *buffer)
+{
+    u8 *ptr = buffer;
+
+    // Call delegation method
+    ptr += willSaveToBuffer(ptr);
+
+    // Save internal state of all subcomponents
+    for (C64Component *c : subComponents) {
+        ptr += c->saveDelta(ptr);
+    }
+
+    // Save internal state of this component
+    ptr += _saveDelta(ptr);
+
+    // Call delegation method
+    ptr += didSaveToBuffer(ptr);
+    isize result = (isize)(ptr - buffer);
+    
+    // Verify that the number of written bytes matches the delta size
+    trace(SNP_DEBUG, "Saved %zd delta bytes (expected %zd)\n", result, deltaSize());
+    assert(result == deltaSize());
+
+    return result;
+}
+
+void
+C64Component::markDirty()
+{
+    for (C64Component *c : subComponents) { c->markDirty(); }
+    _markDirty();
+}
+
+void
+C64Component::markClean()
+{
+    for (C64Component *c : subComponents) { c->markClean(); }
+    _markClean();
+}
+
 void
 C64Component::isReady() const
 {
@@ -120,6 +120,31 @@ public:
     virtual isize willSaveToBuffer(const u8 *buf) {return 0; }
     virtual isize didSaveToBuffer(u8 *buf) { return 0; }
     
+    /* Counterparts of size(), load(), and save() for delta snapshots. Most
+     * components store their full state in a delta snapshot which is why the
+     * default implementations fall back to the standard methods. Components
+     * with large memory blocks override these methods to store only those
+     * memory pages that have been modified since the previous delta snapshot
+     * was taken (see class DirtyPages). Because delta snapshots can be read
+     * from files, loadDelta() gets passed the end of the buffer and throws
+     * ERROR_SNP_CORRUPTED if the data does not fit into it.
+     */
+    isize deltaSize();
+    virtual isize _deltaSize() { return _size(); }
+    isize loadDelta(const u8 *buf, const u8 *end);
+    virtual isize _loadDelta(const u8 *buf, const u8 *end);
+    isize saveDelta(u8 *buf);
+    virtual isize _saveDelta(u8 *buf) { return _save(buf); }
+
+    /* Marks all tracked memory pages as modified or unmodified. The emulator
+     * marks all pages as unmodified after a delta snapshot has been taken and
+     * as modified after a snapshot has been restored.
+     */
+    void markDirty();
+    virtual void _markDirty() { }
+    void markClean();
+    virtual void _markClean() { }
+    
     
     //
     // Controlling the state (see Thread class for details)
@@ -27,6 +27,7 @@ enum_long(OPT)
     OPT_SATURATION,
     OPT_GRAY_DOT_BUG,
     OPT_VIC_POWER_SAVE,
+    OPT_VIC_RGBA_OUTPUT,
     
     // Sprite debugger
     OPT_HIDE_SPRITES,
@@ -69,6 +70,7 @@ enum_long(OPT)
     OPT_SID_POWER_SAVE,
     OPT_SID_ENGINE,
     OPT_SID_SAMPLING,
+    OPT_SID_ASYNC,
     OPT_AUDPAN,
     OPT_AUDVOL,
     OPT_AUDVOLL,
@@ -85,6 +87,7 @@ enum_long(OPT)
     OPT_DRV_CONNECT,
     OPT_DRV_POWER_SWITCH,
     OPT_DRV_POWER_SAVE,
+    OPT_DRV_ACCELERATE,
     OPT_DRV_EJECT_DELAY,
     OPT_DRV_SWAP_DELAY,
     OPT_DRV_INSERT_DELAY,
@@ -93,6 +96,10 @@ enum_long(OPT)
     OPT_DRV_STEP_VOL,
     OPT_DRV_INSERT_VOL,
     OPT_DRV_EJECT_VOL,
+    
+    // Rewind buffer
+    OPT_REWIND_INTERVAL,
+    OPT_REWIND_BUDGET,
             
     OPT_COUNT
 };
@@ -102,7 +109,7 @@ typedef OPT Option;
 struct OptionEnum : util::Reflection<OptionEnum, Option> {
     
     static long min() { return 0; }
-    static long max() { return OPT_DRV_EJECT_VOL; }
+    static long max() { return OPT_REWIND_BUDGET; }
     static bool isValid(long value) { return value >= min() && value <= max(); }
 
     static const char *prefix() { return "OPT"; }
@@ -117,6 +124,7 @@ struct OptionEnum : util::Reflection<OptionEnum, Option> {
             case OPT_SATURATION:          return "SATURATION";
             case OPT_GRAY_DOT_BUG:        return "GRAY_DOT_BUG";
             case OPT_VIC_POWER_SAVE:      return "VIC_POWER_SAVE";
+            case OPT_VIC_RGBA_OUTPUT:     return "VIC_RGBA_OUTPUT";
                 
             case OPT_HIDE_SPRITES:        return "HIDE_SPRITES";
             case OPT_CUT_LAYERS:          return "CUT_LAYERS";
@@ -151,6 +159,7 @@ struct OptionEnum : util::Reflection<OptionEnum, Option> {
             case OPT_SID_POWER_SAVE:      return "SID_POWER_SAVE";
             case OPT_SID_ENGINE:          return "SID_ENGINE";
             case OPT_SID_SAMPLING:        return "SID_SAMPLING";
+            case OPT_SID_ASYNC:           return "SID_ASYNC";
             case OPT_AUDPAN:              return "AUDPAN";
             case OPT_AUDVOL:              return "AUDVOL";
             case OPT_AUDVOLL:             return "AUDVOLL";
@@ -165,6 +174,7 @@ struct OptionEnum : util::Reflection<OptionEnum, Option> {
             case OPT_DRV_CONNECT:         return "DRV_CONNECT";
             case OPT_DRV_POWER_SWITCH:    return "DRV_POWER_SWITCH";
             case OPT_DRV_POWER_SAVE:      return "DRV_POWER_SAVE";
+            case OPT_DRV_ACCELERATE:      return "DRV_ACCELERATE";
             case OPT_DRV_EJECT_DELAY:     return "DRV_EJECT_DELAY";
             case OPT_DRV_SWAP_DELAY:      return "DRV_SWAP_DELAY";
             case OPT_DRV_INSERT_DELAY:    return "DRV_INSERT_DELAY";
@@ -173,6 +183,9 @@ struct OptionEnum : util::Reflection<OptionEnum, Option> {
             case OPT_DRV_STEP_VOL:        return "DRV_STEP_VOL";
             case OPT_DRV_INSERT_VOL:      return "DRV_INSERT_VOL";
             case OPT_DRV_EJECT_VOL:       return "DRV_EJECT_VOL";
+                
+            case OPT_REWIND_INTERVAL:     return "REWIND_INTERVAL";
+            case OPT_REWIND_BUDGET:       return "REWIND_BUDGET";
                                 
             case OPT_COUNT:               return "???";
         }
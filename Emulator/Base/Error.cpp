@@ -93,6 +93,19 @@ VC64Error::VC64Error(ErrorCode code, const string &s)
             description += " and is incompatible with this release.";
             break;
 
+        case ERROR_SNP_NOT_RECORDED:
+            description = "The requested point in time is not covered by the rewind buffer.";
+            break;
+
+        case ERROR_SNP_ROM_MISSING:
+            description = "The snapshot refers to a Rom which is not available.";
+            description += " Please install the Rom and try again.";
+            break;
+
+        case ERROR_SNP_CORRUPTED:
+            description = "The snapshot data is corrupted.";
+            break;
+
         case ERROR_DRV_UNCONNECTED:
             description = "Drive is unconnected.";
             break;
@@ -43,6 +43,9 @@ enum_long(ERROR_CODE)
     // Snapshots
     ERROR_SNP_TOO_OLD,
     ERROR_SNP_TOO_NEW,
+    ERROR_SNP_NOT_RECORDED,
+    ERROR_SNP_ROM_MISSING,
+    ERROR_SNP_CORRUPTED,
 
     // Drives
     ERROR_DRV_UNCONNECTED,
@@ -104,6 +107,9 @@ struct ErrorCodeEnum : util::Reflection<ErrorCodeEnum, ErrorCode> {
                 
             case ERROR_SNP_TOO_OLD:          return "SNP_TOO_OLD";
             case ERROR_SNP_TOO_NEW:          return "SNP_TOO_NEW";
+            case ERROR_SNP_NOT_RECORDED:     return "SNP_NOT_RECORDED";
+            case ERROR_SNP_ROM_MISSING:      return "SNP_ROM_MISSING";
+            case ERROR_SNP_CORRUPTED:        return "SNP_CORRUPTED";
 
             case ERROR_DRV_UNCONNECTED:      return "DRV_UNCONNECTED";
 
@@ -0,0 +1,196 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "Profiler.h"
+#include "C64.h"
+
+#include <fstream>
+#include <iomanip>
+
+void
+Profiler::_dump(dump::Category category, std::ostream& os) const
+{
+    using namespace util;
+
+    if (!CYCLE_PROFILER) {
+
+        os << "The profiler is disabled. Set CYCLE_PROFILER in config.h ";
+        os << "to enable it." << std::endl;
+        return;
+    }
+
+    if (category & dump::State) {
+
+        auto scale = ticksPerNs();
+        i64 total = 0;
+        for (isize i = 0; i < PROF_COUNT; i++) total += totalTicks[i];
+
+        os << tab("Profiled frames");
+        os << dec(frames) << std::endl;
+        os << tab("Ticks per ns");
+        os << scale << std::endl;
+        os << tab("Ticks per measurement");
+        os << dec(overhead) << std::endl;
+
+        if (frames == 0 || total == 0) return;
+
+        os << std::endl;
+        for (isize i = 0; i < PROF_COUNT; i++) {
+
+            auto avg = totalTicks[i] / scale / frames / 1000.0;
+            auto min = minTicks[i] / scale / 1000.0;
+            auto max = maxTicks[i] / scale / 1000.0;
+            auto share = 100.0 * totalTicks[i] / total;
+
+            os << tab(ProfilerSlotEnum::key(ProfilerSlot(i)));
+            os << std::fixed << std::setprecision(1);
+            os << avg << " us/frame (" << share << "%), ";
+            os << "min " << min << " us, max " << max << " us" << std::endl;
+        }
+
+        for (isize i = 0; i < PROF_COUNT; i++) {
+
+            os << std::endl;
+            os << ProfilerSlotEnum::key(ProfilerSlot(i)) << ":" << std::endl;
+
+            for (isize b = 0; b < numBuckets; b++) {
+
+                if (histogram[i][b] == 0) continue;
+
+                auto lo = b ? (1LL << (b - 1)) / scale / 1000.0 : 0.0;
+                auto hi = (1LL << b) / scale / 1000.0;
+                auto share = 100.0 * histogram[i][b] / frames;
+
+                std::stringstream ss;
+                ss << std::fixed << std::setprecision(1) << lo << " - " << hi << " us";
+                os << tab(ss.str());
+                os << std::setw(5) << share << "% ";
+                os << string(isize(share / 2.5), '#') << std::endl;
+            }
+        }
+        os << std::defaultfloat;
+    }
+}
+
+void
+Profiler::_reset(bool hard)
+{
+    clear();
+}
+
+void
+Profiler::vsyncHandler()
+{
+    for (isize i = 0; i < PROF_COUNT; i++) {
+
+        auto ticks = std::max(frameTicks[i] - frameIntervals[i] * overhead, 0LL);
+
+        totalTicks[i] += ticks;
+        minTicks[i] = frames ? std::min(minTicks[i], ticks) : ticks;
+        maxTicks[i] = frames ? std::max(maxTicks[i], ticks) : ticks;
+        histogram[i][bucket(ticks)]++;
+        frameTicks[i] = frameIntervals[i] = 0;
+    }
+    frames++;
+}
+
+void
+Profiler::clear()
+{
+    calibrate();
+
+    for (isize i = 0; i < PROF_COUNT; i++) {
+
+        frameTicks[i] = frameIntervals[i] = 0;
+        totalTicks[i] = minTicks[i] = maxTicks[i] = 0;
+        for (isize b = 0; b < numBuckets; b++) histogram[i][b] = 0;
+    }
+    frames = 0;
+
+    startStamp = stamp();
+    startTime = util::Time::now();
+    resume();
+}
+
+void
+Profiler::calibrate()
+{
+    // Take the fastest of several runs to filter out interruptions
+    overhead = INT64_MAX;
+
+    for (isize run = 0; run < 16; run++) {
+
+        auto start = stamp();
+        for (isize i = 0; i < 64; i++) enter(current);
+        overhead = std::min(overhead, (i64)(stamp() - start) / 64);
+    }
+}
+
+double
+Profiler::ticksPerNs() const
+{
+    auto ticks = stamp() - startStamp;
+    auto ns = (util::Time::now() - startTime).asNanoseconds();
+
+    return ns > 0 && ticks > 0 ? (double)ticks / ns : 1.0;
+}
+
+void
+Profiler::exportStats(std::ostream& os) const
+{
+    auto scale = ticksPerNs();
+
+    os << "{" << std::endl;
+    os << "  \"frames\": " << frames << "," << std::endl;
+    os << "  \"ticksPerNs\": " << scale << "," << std::endl;
+    os << "  \"overheadTicks\": " << overhead << "," << std::endl;
+    os << "  \"slots\": [" << std::endl;
+
+    for (isize i = 0; i < PROF_COUNT; i++) {
+
+        os << "    { ";
+        os << "\"name\": \"" << ProfilerSlotEnum::key(ProfilerSlot(i)) << "\", ";
+        os << "\"totalNs\": " << i64(totalTicks[i] / scale) << ", ";
+        os << "\"minNs\": " << i64(minTicks[i] / scale) << ", ";
+        os << "\"maxNs\": " << i64(maxTicks[i] / scale) << ", ";
+        os << "\"histogram\": [";
+
+        // Each bucket is written as [lower bound, upper bound, frames]
+        bool first = true;
+        for (isize b = 0; b < numBuckets; b++) {
+
+            if (histogram[i][b] == 0) continue;
+
+            auto lo = b ? i64((1LL << (b - 1)) / scale) : 0;
+            auto hi = i64((1LL << b) / scale);
+
+            os << (first ? "" : ", ");
+            os << "[" << lo << ", " << hi << ", " << histogram[i][b] << "]";
+            first = false;
+        }
+
+        os << "] }" << (i < PROF_COUNT - 1 ? "," : "") << std::endl;
+    }
+
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+}
+
+void
+Profiler::exportStats(const string &path) const
+{
+    std::ofstream stream(path);
+
+    if (!stream.is_open()) {
+        throw VC64Error(ERROR_FILE_CANT_WRITE, path);
+    }
+
+    exportStats(stream);
+}
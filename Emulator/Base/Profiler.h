@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "ProfilerTypes.h"
+#include "SubComponent.h"
+#include "Chrono.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* The profiler measures how much host time is spent inside the different
+ * components of the emulator. It is enabled by setting CYCLE_PROFILER in
+ * config.h. If the flag is zero, all calls into the profiler are removed by
+ * the compiler.
+ *
+ * At any time, exactly one slot is active which is charged for the elapsed
+ * host time. C64::_executeOneCycle() switches the slot each time it hands
+ * control over to another component. Components that are invoked from within
+ * other components (e.g., SID which is called when the CPU writes into a SID
+ * register) switch to their own slot temporarily and restore the previous
+ * slot afterwards.
+ *
+ * At the end of each frame, the accumulated time of each slot is added to a
+ * histogram with logarithmically spaced buckets. Time is measured in ticks of
+ * the host's time stamp counter. Ticks are converted to nanoseconds when the
+ * results are reported.
+ */
+class Profiler : public SubComponent {
+
+    // Number of histogram buckets (bucket n counts values in [2^(n-1), 2^n))
+    static constexpr isize numBuckets = 64;
+
+    // The currently charged slot
+    ProfilerSlot current = PROF_OTHER;
+
+    // Time stamp of the most recent slot switch
+    u64 last = 0;
+
+    // Ticks and measured intervals accumulated in the current frame
+    i64 frameTicks[PROF_COUNT] = { };
+    i64 frameIntervals[PROF_COUNT] = { };
+
+    // Time needed to read the time stamp counter (subtracted for each interval)
+    i64 overhead = 0;
+
+    // Statistics over all frames
+    i64 totalTicks[PROF_COUNT] = { };
+    i64 minTicks[PROF_COUNT] = { };
+    i64 maxTicks[PROF_COUNT] = { };
+    i64 histogram[PROF_COUNT][numBuckets] = { };
+
+    // Number of profiled frames
+    i64 frames = 0;
+
+    // Reference points for converting ticks to nanoseconds
+    u64 startStamp = 0;
+    util::Time startTime;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    using SubComponent::SubComponent;
+
+
+    //
+    // Methods from C64Object
+    //
+
+private:
+
+    const char *getDescription() const override { return "Profiler"; }
+    void _dump(dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Methods from C64Component
+    //
+
+private:
+
+    void _reset(bool hard) override;
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Measuring
+    //
+
+public:
+
+    // Reads the host's time stamp counter
+    static u64 stamp()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        u64 result;
+        asm volatile("mrs %0, cntvct_el0" : "=r" (result));
+        return result;
+#else
+        return (u64)util::Time::now().asNanoseconds();
+#endif
+    }
+
+    // Charges the elapsed time and activates another slot
+    ProfilerSlot enter(ProfilerSlot slot)
+    {
+        auto now = stamp();
+        auto result = current;
+
+        frameTicks[current] += (i64)(now - last);
+        frameIntervals[current]++;
+        last = now;
+        current = slot;
+
+        return result;
+    }
+
+    // Restarts the measurement without charging the elapsed time
+    void resume() { last = stamp(); current = PROF_OTHER; }
+
+    // Adds the values of the current frame to the statistics
+    void vsyncHandler();
+
+    // Discards all gathered information
+    void clear();
+
+private:
+
+    // Measures the time needed to read the time stamp counter
+    void calibrate();
+
+
+    //
+    // Reporting
+    //
+
+public:
+
+    // Returns the number of ticks per nanosecond
+    double ticksPerNs() const;
+
+    // Writes the gathered information in JSON format
+    void exportStats(std::ostream& os) const;
+    void exportStats(const string &path) const throws;
+
+private:
+
+    // Returns the histogram bucket for a certain number of ticks
+    static isize bucket(i64 ticks) { return ticks ? 64 - __builtin_clzll(ticks) : 0; }
+};
@@ -0,0 +1,58 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+#include "Reflection.h"
+
+//
+// Enumerations
+//
+
+enum_long(PROF_SLOT)
+{
+    PROF_VICII,
+    PROF_CIA,
+    PROF_IEC,
+    PROF_CPU,
+    PROF_DRIVE,
+    PROF_DATASETTE,
+    PROF_SID,
+    PROF_OTHER,
+    PROF_COUNT
+};
+typedef PROF_SLOT ProfilerSlot;
+
+#ifdef __cplusplus
+struct ProfilerSlotEnum : util::Reflection<ProfilerSlotEnum, ProfilerSlot> {
+    
+    static long min() { return 0; }
+    static long max() { return PROF_OTHER; }
+    static bool isValid(long value) { return value >= min() && value <= max(); }
+
+    static const char *prefix() { return "PROF"; }
+    static const char *key(ProfilerSlot value)
+    {
+        switch (value) {
+                
+            case PROF_VICII:       return "VICII";
+            case PROF_CIA:         return "CIA";
+            case PROF_IEC:         return "IEC";
+            case PROF_CPU:         return "CPU";
+            case PROF_DRIVE:       return "DRIVE";
+            case PROF_DATASETTE:   return "DATASETTE";
+            case PROF_SID:         return "SID";
+            case PROF_OTHER:       return "OTHER";
+            case PROF_COUNT:       return "???";
+        }
+        return "???";
+    }
+};
+#endif
@@ -0,0 +1,259 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "RewindBuffer.h"
+#include "C64.h"
+
+void
+RewindBuffer::_dump(dump::Category category, std::ostream& os) const
+{
+    using namespace util;
+
+    if (category & dump::Config) {
+
+        os << tab("Interval");
+        os << dec(config.interval) << " frames" << std::endl;
+        os << tab("Memory budget");
+        os << dec(config.budget) << " MB" << std::endl;
+    }
+
+    if (category & dump::State) {
+
+        os << tab("Recorded states");
+        os << dec(count()) << std::endl;
+        os << tab("Pooled buffers");
+        os << dec((isize)pool.size()) << std::endl;
+        os << tab("Allocated memory");
+        os << dec(allocated / 1024) << " KB" << std::endl;
+        if (auto first = oldest()) {
+            os << tab("Oldest state");
+            os << "Frame " << dec(first->frame) << ", Cycle " << dec(first->cycle) << std::endl;
+        }
+        if (auto last = latest()) {
+            os << tab("Latest state");
+            os << "Frame " << dec(last->frame) << ", Cycle " << dec(last->cycle) << std::endl;
+        }
+        os << tab("Total records");
+        os << dec(recorded) << std::endl;
+        os << tab("Recycled records");
+        os << dec(recycled) << std::endl;
+    }
+}
+
+void
+RewindBuffer::_reset(bool hard)
+{
+    // Recorded states from before the reset can no longer be restored
+    clear();
+}
+
+RewindConfig
+RewindBuffer::getDefaultConfig()
+{
+    RewindConfig defaults;
+
+    defaults.interval = 0;
+    defaults.budget = 32;
+
+    return defaults;
+}
+
+void
+RewindBuffer::resetConfig()
+{
+    RewindConfig defaults = getDefaultConfig();
+
+    setConfigItem(OPT_REWIND_INTERVAL, defaults.interval);
+    setConfigItem(OPT_REWIND_BUDGET, defaults.budget);
+}
+
+i64
+RewindBuffer::getConfigItem(Option option) const
+{
+    switch (option) {
+
+        case OPT_REWIND_INTERVAL:  return config.interval;
+        case OPT_REWIND_BUDGET:    return config.budget;
+
+        default:
+            fatalError;
+    }
+}
+
+void
+RewindBuffer::setConfigItem(Option option, i64 value)
+{
+    switch (option) {
+
+        case OPT_REWIND_INTERVAL:
+
+            if (value < 0) {
+                throw VC64Error(ERROR_OPT_INVARG, "0, 1, 2, ...");
+            }
+
+            suspended {
+
+                config.interval = (isize)value;
+
+                // Free all buffers if the rewind buffer has been disabled
+                if (config.interval == 0) {
+
+                    entries.clear();
+                    pool.clear();
+                    allocated = 0;
+                }
+            }
+            return;
+
+        case OPT_REWIND_BUDGET:
+
+            if (value < 1) {
+                throw VC64Error(ERROR_OPT_INVARG, "1, 2, 3, ... (MB)");
+            }
+
+            suspended {
+
+                config.budget = (isize)value;
+                trim();
+            }
+            return;
+
+        default:
+            fatalError;
+    }
+}
+
+const RewindEntry *
+RewindBuffer::oldest() const
+{
+    return entries.empty() ? nullptr : entries.front().get();
+}
+
+const RewindEntry *
+RewindBuffer::latest() const
+{
+    return entries.empty() ? nullptr : entries.back().get();
+}
+
+const RewindEntry *
+RewindBuffer::find(Cycle cycle) const
+{
+    for (auto it = entries.rbegin(); it != entries.rend(); it++) {
+        if ((*it)->cycle <= cycle) return it->get();
+    }
+    return nullptr;
+}
+
+void
+RewindBuffer::clear()
+{
+    while (!entries.empty()) {
+
+        release(std::move(entries.back()));
+        entries.pop_back();
+    }
+}
+
+void
+RewindBuffer::vsyncHandler()
+{
+    if (config.interval && c64.frame % config.interval == 0) record();
+}
+
+void
+RewindBuffer::record()
+{
+    auto entry = acquire(c64.size());
+
+    entry->frame = c64.frame;
+    entry->cycle = cpu.cycle;
+    entry->size = c64.save(entry->data.data());
+
+    trace(SNP_DEBUG, "Recorded frame %lld (%zd bytes)\n", entry->frame, entry->size);
+
+    entries.push_back(std::move(entry));
+    recorded++;
+
+    trim();
+}
+
+void
+RewindBuffer::restore(const RewindEntry &entry)
+{
+    trace(SNP_DEBUG, "Restoring frame %lld\n", entry.frame);
+
+    c64.load(entry.data.data());
+
+    // Discard all states that are newer than the restored one
+    while (!entries.empty() && entries.back()->cycle > (Cycle)cpu.cycle) {
+
+        release(std::move(entries.back()));
+        entries.pop_back();
+    }
+}
+
+std::unique_ptr<RewindEntry>
+RewindBuffer::acquire(isize capacity)
+{
+    std::unique_ptr<RewindEntry> result;
+
+    if (!pool.empty()) {
+
+        // Reuse a pooled buffer
+        result = std::move(pool.back());
+        pool.pop_back();
+
+    } else if (!entries.empty() && allocated + capacity > maxBytes()) {
+
+        // Overwrite the oldest state
+        result = std::move(entries.front());
+        entries.pop_front();
+        recycled++;
+
+    } else {
+
+        // Allocate a new buffer
+        result = std::make_unique<RewindEntry>();
+    }
+
+    // Grow the buffer if necessary
+    if ((isize)result->data.size() < capacity) {
+
+        allocated += capacity - (isize)result->data.size();
+        result->data.resize(capacity);
+    }
+
+    return result;
+}
+
+void
+RewindBuffer::release(std::unique_ptr<RewindEntry> entry)
+{
+    pool.push_back(std::move(entry));
+}
+
+void
+RewindBuffer::trim()
+{
+    // Free pooled buffers first
+    while (allocated > maxBytes() && !pool.empty()) {
+
+        allocated -= (isize)pool.back()->data.size();
+        pool.pop_back();
+    }
+
+    // Free the oldest states, but always keep the latest one
+    while (allocated > maxBytes() && entries.size() > 1) {
+
+        allocated -= (isize)entries.front()->data.size();
+        entries.pop_front();
+        recycled++;
+    }
+}
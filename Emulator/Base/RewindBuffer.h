@@ -0,0 +1,168 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "RewindBufferTypes.h"
+#include "SubComponent.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+/* The rewind buffer keeps a history of past emulator states. Every few frames,
+ * the complete state of the C64 is serialized into an in-memory buffer, just
+ * like it is done when a snapshot is taken. Other than a snapshot, no
+ * thumbnail image and no header is stored.
+ *
+ * The recorded states are organized as a ring. The size of the ring is
+ * limited by a memory budget. Once the budget is used up, the oldest state is
+ * overwritten by the newest one. Buffers are never freed during normal
+ * operation. They are either reused directly or moved into a pool from which
+ * they are taken again when the next state is recorded.
+ *
+ * To travel back in time, C64::rewindTo() restores the latest state recorded
+ * before the requested cycle and emulates the machine from there until the
+ * requested cycle is reached. Because states are recorded every 'interval'
+ * frames, at most 'interval' frames need to be emulated.
+ */
+
+struct RewindEntry {
+
+    // Frame and cycle at the time the state was recorded
+    u64 frame = 0;
+    Cycle cycle = 0;
+
+    // The serialized emulator state (might be larger than needed)
+    std::vector<u8> data;
+
+    // Number of used bytes in the data buffer
+    isize size = 0;
+};
+
+class RewindBuffer : public SubComponent {
+
+    // Current configuration
+    RewindConfig config = { };
+
+    // Recorded states (the oldest one comes first)
+    std::deque<std::unique_ptr<RewindEntry>> entries;
+
+    // Unused buffers that are recycled when the next state is recorded
+    std::vector<std::unique_ptr<RewindEntry>> pool;
+
+    // Number of bytes occupied by all buffers (including the pooled ones)
+    isize allocated = 0;
+
+    // Total number of recorded states
+    i64 recorded = 0;
+
+    // Number of recorded states that were recycled to meet the budget
+    i64 recycled = 0;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    using SubComponent::SubComponent;
+
+
+    //
+    // Methods from C64Object
+    //
+
+private:
+
+    const char *getDescription() const override { return "RewindBuffer"; }
+    void _dump(dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Methods from C64Component
+    //
+
+private:
+
+    void _reset(bool hard) override;
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    static RewindConfig getDefaultConfig();
+    const RewindConfig &getConfig() const { return config; }
+    void resetConfig() override;
+
+    i64 getConfigItem(Option option) const;
+    void setConfigItem(Option option, i64 value);
+
+private:
+
+    // Returns the memory budget in bytes
+    isize maxBytes() const { return config.budget * 1024 * 1024; }
+
+
+    //
+    // Accessing
+    //
+
+public:
+
+    // Returns the number of recorded states
+    isize count() const { return (isize)entries.size(); }
+
+    // Returns the oldest or the latest recorded state
+    const RewindEntry *oldest() const;
+    const RewindEntry *latest() const;
+
+    // Returns the latest state recorded at or before a certain cycle
+    const RewindEntry *find(Cycle cycle) const;
+
+    // Discards all recorded states
+    void clear();
+
+
+    //
+    // Recording and restoring
+    //
+
+public:
+
+    // Records the current state if the end of an interval has been reached
+    void vsyncHandler();
+
+    // Records the current state
+    void record();
+
+    /* Restores a recorded state. All states that were recorded afterwards are
+     * discarded. They will be recorded again while the emulator proceeds.
+     */
+    void restore(const RewindEntry &entry);
+
+private:
+
+    // Returns a buffer with at least the specified capacity
+    std::unique_ptr<RewindEntry> acquire(isize capacity);
+
+    // Returns a buffer to the pool
+    void release(std::unique_ptr<RewindEntry> entry);
+
+    // Frees the oldest buffers until the memory budget is met
+    void trim();
+};
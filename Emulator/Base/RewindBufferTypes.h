@@ -0,0 +1,26 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Number of frames between two recorded states (0 = disabled)
+    isize interval;
+    
+    // Maximum amount of memory occupied by all recorded states in MB
+    isize budget;
+}
+RewindConfig;
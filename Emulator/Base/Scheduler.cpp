@@ -0,0 +1,352 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "Scheduler.h"
+#include "IO.h"
+
+#include <algorithm>
+
+Scheduler::Scheduler(isize numWorkers)
+{
+    if (numWorkers <= 0) numWorkers = std::thread::hardware_concurrency();
+    if (numWorkers <= 0) numWorkers = 1;
+
+    debug(RUN_DEBUG, "Launching %zd workers\n", numWorkers);
+
+    for (isize i = 0; i < numWorkers; i++) {
+        workers.push_back(std::make_unique<SchedulerWorker>());
+    }
+    for (isize i = 0; i < numWorkers; i++) {
+        workers[i]->thread = std::thread(&Scheduler::main, this, i);
+    }
+}
+
+Scheduler::~Scheduler()
+{
+    // Terminate all workers
+    stopping = true;
+    cond.notify_all();
+
+    for (auto &w : workers) if (w->thread.joinable()) w->thread.join();
+}
+
+void
+Scheduler::_dump(dump::Category category, std::ostream& os) const
+{
+    using namespace util;
+
+    auto elapsed = clock.getElapsedTime().asSeconds();
+
+    if (category & dump::State) {
+
+        os << tab("Workers") << dec((i64)workers.size()) << std::endl;
+        os << tab("Jobs") << dec((i64)jobs.size()) << std::endl;
+        os << tab("Executed slices") << dec(totalSlices()) << std::endl;
+        os << tab("Slices per second") << totalSlices() / elapsed << std::endl;
+        os << tab("Fairness") << fairness() << std::endl;
+    }
+
+    if (category & dump::Events) {
+
+        for (usize i = 0; i < workers.size(); i++) {
+
+            auto &w = *workers[i];
+            os << tab("Worker " + std::to_string(i));
+            os << dec(w.slices) << " slices, ";
+            os << dec(w.steals) << " steals" << std::endl;
+        }
+        for (usize i = 0; i < jobs.size(); i++) {
+
+            auto &j = *jobs[i];
+            auto host = j.hostTime / 1000000000.0;
+            os << tab("Job " + std::to_string(i));
+            os << dec(j.slices) << " slices, ";
+            os << host << " sec, ";
+            os << (host > 0 ? j.slices / host : 0.0) << " slices/sec, ";
+            os << j.maxSlice / 1000 << " usec max, ";
+            os << dec(j.stolen) << " stolen" << std::endl;
+        }
+    }
+}
+
+i64
+Scheduler::totalSlices() const
+{
+    i64 result = 0;
+    for (auto &w : workers) result += w->slices;
+    return result;
+}
+
+double
+Scheduler::fairness() const
+{
+    double sum = 0.0, sqsum = 0.0;
+
+    for (auto &j : jobs) {
+
+        double share = (double)j->hostTime;
+        sum += share;
+        sqsum += share * share;
+    }
+
+    return sqsum > 0.0 ? (sum * sum) / (jobs.size() * sqsum) : 1.0;
+}
+
+void
+Scheduler::add(Thread &thread, isize budget)
+{
+    assert(!thread.isThreaded());
+
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        assert(find(thread) == nullptr);
+        jobs.push_back(std::make_unique<SchedulerJob>(&thread, budget));
+    }
+    cond.notify_all();
+}
+
+void
+Scheduler::remove(Thread &thread)
+{
+    SchedulerJob *job;
+
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        if (!(job = find(thread))) return;
+        job->removed = true;
+    }
+
+    // Take the job out of all work queues
+    for (auto &w : workers) {
+
+        std::lock_guard<std::mutex> lock(w->mutex);
+        w->queue.erase(std::remove(w->queue.begin(), w->queue.end(), job),
+                       w->queue.end());
+    }
+
+    // Wait until the job is no longer executed
+    while (job->active) std::this_thread::yield();
+
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+                                  [job](auto &j) { return j.get() == job; }),
+                   jobs.end());
+    }
+    cond.notify_all();
+}
+
+void
+Scheduler::setBudget(Thread &thread, isize budget)
+{
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        if (auto job = find(thread)) job->budget = budget;
+    }
+    cond.notify_all();
+}
+
+void
+Scheduler::waitForCompletion()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    cond.wait(lock, [this]() {
+
+        for (auto &j : jobs) if (isRunnable(*j) || j->active) return false;
+        return true;
+    });
+}
+
+SchedulerJob *
+Scheduler::find(Thread &thread)
+{
+    for (auto &j : jobs) if (j->thread == &thread) return j.get();
+    return nullptr;
+}
+
+bool
+Scheduler::isRunnable(const SchedulerJob &job) const
+{
+    return !job.removed && job.budget != 0 && job.thread->isRunning();
+}
+
+void
+Scheduler::main(isize nr)
+{
+    auto &worker = *workers[nr];
+
+    // Number of consecutive jobs that were not due
+    isize skipped = 0;
+
+    // Earliest due time of all skipped jobs
+    util::Time earliest;
+
+    while (!stopping) {
+
+        bool stolen = false;
+
+        // Get the next job
+        auto job = pop(nr);
+        if (!job) { job = steal(nr); stolen = true; }
+        if (!job) { idle(nr); skipped = 0; continue; }
+
+        // Only proceed if the job is due
+        auto due = job->thread->nextSlice();
+        auto now = util::Time::now();
+
+        if (due > now) {
+
+            if (skipped == 0 || due < earliest) earliest = due;
+            push(nr, job);
+
+            // Sleep if none of the jobs in the queue is due
+            isize size;
+            { std::lock_guard<std::mutex> lock(worker.mutex); size = worker.queue.size(); }
+
+            if (++skipped >= size) {
+
+                std::unique_lock<std::mutex> lock(mutex);
+                auto delay = std::min((earliest - now).asNanoseconds(), (i64)5000000);
+                cond.wait_for(lock, std::chrono::nanoseconds(delay));
+                skipped = 0;
+            }
+            continue;
+        }
+
+        skipped = 0;
+        execute(nr, job, stolen);
+    }
+}
+
+SchedulerJob *
+Scheduler::pop(isize nr)
+{
+    auto &worker = *workers[nr];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+
+    if (worker.queue.empty()) return nullptr;
+
+    auto job = worker.queue.front();
+    worker.queue.pop_front();
+    job->active = true;
+    return job;
+}
+
+SchedulerJob *
+Scheduler::steal(isize nr)
+{
+    isize count = (isize)workers.size();
+
+    for (isize i = 1; i < count; i++) {
+
+        auto &victim = *workers[(nr + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (!victim.queue.empty()) {
+
+            auto job = victim.queue.back();
+            victim.queue.pop_back();
+            job->active = true;
+            workers[nr]->steals++;
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void
+Scheduler::execute(isize nr, SchedulerJob *job, bool stolen)
+{
+    auto &worker = *workers[nr];
+
+    // Execute a single slice
+    auto start = util::Time::now();
+    bool running = job->thread->executeSlice();
+    auto elapsed = (util::Time::now() - start).asNanoseconds();
+
+    if (running) {
+
+        // Update statistics
+        job->slices++;
+        job->hostTime += elapsed;
+        if (elapsed > job->maxSlice) job->maxSlice = elapsed;
+        if (stolen) job->stolen++;
+        worker.slices++;
+
+        bool exhausted;
+        {   std::lock_guard<std::mutex> lock(mutex);
+
+            if (job->budget > 0) job->budget--;
+            exhausted = !isRunnable(*job);
+        }
+
+        // Append the job to the back of the queue (round robin)
+        if (!exhausted) { push(nr, job); return; }
+    }
+
+    park(job);
+}
+
+void
+Scheduler::push(isize nr, SchedulerJob *job)
+{
+    auto &worker = *workers[nr];
+
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        // Drop the job if it has been removed in the meantime
+        if (job->removed) {
+            
+            job->queued = false;
+            
+        } else {
+            
+            std::lock_guard<std::mutex> wlock(worker.mutex);
+            worker.queue.push_back(job);
+        }
+        job->active = false;
+    }
+}
+
+void
+Scheduler::park(SchedulerJob *job)
+{
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        job->queued = false;
+        job->active = false;
+    }
+    cond.notify_all();
+}
+
+void
+Scheduler::idle(isize nr)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Reschedule all jobs that have become runnable again
+    bool found = false;
+    for (auto &j : jobs) {
+
+        if (!j->queued && !j->active && isRunnable(*j)) {
+
+            j->queued = true;
+            {   std::lock_guard<std::mutex> wlock(workers[nr]->mutex);
+                workers[nr]->queue.push_back(j.get());
+            }
+            found = true;
+        }
+    }
+
+    // Wait for something to happen if there is nothing to do
+    if (!found && !stopping) cond.wait_for(lock, std::chrono::milliseconds(10));
+}
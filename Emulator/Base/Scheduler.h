@@ -0,0 +1,197 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "C64Object.h"
+#include "Thread.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* The scheduler runs many emulator instances inside a single process on a
+ * shared pool of worker threads. It is meant for instances that have been
+ * created without their own thread (see class Thread). Each instance is
+ * represented by a job which is executed slice by slice, i.e., frame by frame.
+ *
+ * Every worker owns a queue of jobs. It repeatedly takes the job at the front
+ * of its own queue, executes a single slice, and appends the job to the back
+ * of the queue again. This keeps the instances of a worker in a round-robin
+ * order. If a worker runs out of jobs, it steals a job from the back of
+ * another worker's queue. Jobs of instances that are not running are taken
+ * out of the queues. They are picked up again by the next idle worker once
+ * the instance is running again.
+ *
+ * Instances that are not in warp mode are kept in sync with the real time. A
+ * slice is only executed if it is due (see Thread::nextSlice()).
+ *
+ * Optionally, a job can be assigned a budget. It specifies the number of
+ * slices that are executed before the job is put aside. This is utilized by
+ * the headless runner to emulate a fixed number of frames per instance.
+ */
+
+struct SchedulerJob {
+
+    // The scheduled emulator instance
+    Thread *thread;
+
+    // Remaining number of slices to execute (-1 = unlimited)
+    isize budget = -1;
+
+    // Indicates if the job is stored in one of the work queues
+    bool queued = false;
+
+    // Indicates if the job is executed by one of the workers right now
+    std::atomic<bool> active = false;
+
+    // Indicates if the job has been removed from the scheduler
+    bool removed = false;
+
+    // Number of executed slices
+    std::atomic<i64> slices = 0;
+
+    // Accumulated host time spent in this job in nanoseconds
+    std::atomic<i64> hostTime = 0;
+
+    // Longest slice in nanoseconds
+    std::atomic<i64> maxSlice = 0;
+
+    // Number of slices executed by a worker that stole the job
+    std::atomic<i64> stolen = 0;
+
+    SchedulerJob(Thread *t, isize b) : thread(t), budget(b) { }
+};
+
+struct SchedulerWorker {
+
+    // The worker thread
+    std::thread thread;
+
+    // Jobs assigned to this worker
+    std::deque<SchedulerJob *> queue;
+    std::mutex mutex;
+
+    // Number of executed slices
+    std::atomic<i64> slices = 0;
+
+    // Number of stolen jobs
+    std::atomic<i64> steals = 0;
+};
+
+class Scheduler : public C64Object {
+
+    // All registered jobs
+    std::vector<std::unique_ptr<SchedulerJob>> jobs;
+
+    // The worker pool
+    std::vector<std::unique_ptr<SchedulerWorker>> workers;
+
+    // Protects the job list and all job flags
+    std::mutex mutex;
+
+    // Wakes up idle workers and threads waiting for completion
+    std::condition_variable cond;
+
+    // Set to true to terminate all workers
+    std::atomic<bool> stopping = false;
+
+    // Clock measuring the time since the scheduler has been created
+    mutable util::Clock clock;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    // Creates a pool with the given number of workers (0 = number of cores)
+    Scheduler(isize numWorkers = 0);
+    ~Scheduler();
+
+    const char *getDescription() const override { return "Scheduler"; }
+
+
+    //
+    // Analyzing
+    //
+
+private:
+
+    void _dump(dump::Category category, std::ostream& os) const override;
+
+public:
+
+    // Returns the number of slices executed by all jobs
+    i64 totalSlices() const;
+
+    /* Returns Jain's fairness index for the host time spent in each job. A
+     * value of 1.0 means that all jobs received the same share.
+     */
+    double fairness() const;
+
+
+    //
+    // Managing jobs
+    //
+
+public:
+
+    // Adds an emulator instance
+    void add(Thread &thread, isize budget = -1);
+
+    // Removes an emulator instance (blocks until the current slice is done)
+    void remove(Thread &thread);
+
+    // Assigns a new budget to an emulator instance
+    void setBudget(Thread &thread, isize budget);
+
+    // Blocks until all instances have used up their budgets or stopped
+    void waitForCompletion();
+
+    // Informs the scheduler that an instance has been resumed
+    void wakeUp() { cond.notify_all(); }
+
+private:
+
+    SchedulerJob *find(Thread &thread);
+
+    // Checks if a job is ready to be executed (requires the mutex to be held)
+    bool isRunnable(const SchedulerJob &job) const;
+
+
+    //
+    // Running the workers
+    //
+
+private:
+
+    // Main entry point of a worker
+    void main(isize nr);
+
+    // Takes the next job from a worker's own queue or steals it
+    SchedulerJob *pop(isize nr);
+    SchedulerJob *steal(isize nr);
+
+    // Executes a single slice of a job
+    void execute(isize nr, SchedulerJob *job, bool stolen);
+
+    // Puts a job back into a work queue
+    void push(isize nr, SchedulerJob *job);
+
+    // Puts a job aside (it is no longer runnable)
+    void park(SchedulerJob *job);
+
+    // Reschedules parked jobs or waits for them to become runnable
+    void idle(isize nr);
+};
@@ -41,6 +41,8 @@ private:
 
 public:
 
+    using Thread::Thread;
+
     void suspend() override;
     void resume() override;
 };
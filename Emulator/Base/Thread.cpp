@@ -12,13 +12,13 @@
 #include "Chrono.h"
 #include <iostream>
 
-Thread::Thread()
+Thread::Thread(bool threaded) : threaded(threaded)
 {
     // Initialize the sync timer
     targetTime = util::Time::now();
     
     // Start the thread and enter the main function
-    thread = std::thread(&Thread::main, this);
+    if (threaded) thread = std::thread(&Thread::main, this);
 }
 
 Thread::~Thread()
@@ -52,7 +52,7 @@ Thread::sleep <Thread::SyncMode::Periodic> ()
     auto now = util::Time::now();
 
     // Only proceed if we're not running in warp mode
-    if (warpMode) return;
+    if (warpMode && isRunning()) return;
         
     // Check if we're running too slow...
     if (now > targetTime) {
@@ -109,7 +109,7 @@ Thread::main()
             }
         }
         
-        if (!warpMode || isPaused()) {
+        if (!warpMode || !isRunning()) {
 
             switch (mode) {
                 case SyncMode::Periodic: sleep<SyncMode::Periodic>(); break;
@@ -117,94 +117,138 @@ Thread::main()
             }
         }
         
-        // Are we requested to enter or exit warp mode?
-        while (newWarpMode != warpMode) {
+        // Are we requested to change state?
+        if (!processRequests()) return;
+        
+        // Compute the CPU load once in a while
+        if (loopCounter % 32 == 0) updateCpuLoad();
+    }
+}
+
+bool
+Thread::processRequests()
+{
+    // Are we requested to enter or exit warp mode?
+    while (newWarpMode != warpMode) {
+        
+        C64Component::warpOnOff(newWarpMode);
+        warpMode = newWarpMode;
+        break;
+    }
+
+    // Are we requested to enter or exit debug mode?
+    while (newDebugMode != debugMode) {
+        
+        C64Component::debugOnOff(newDebugMode);
+        debugMode = newDebugMode;
+        break;
+    }
+
+    // Are we requested to change state?
+    while (newState != state) {
+        
+        if (state == EXEC_OFF && newState == EXEC_PAUSED) {
             
-            C64Component::warpOnOff(newWarpMode);
-            warpMode = newWarpMode;
+            C64Component::powerOn();
+            state = newState;
             break;
         }
 
-        // Are we requested to enter or exit warp mode?
-        while (newDebugMode != debugMode) {
+        if (state == EXEC_OFF && newState == EXEC_RUNNING) {
             
-            C64Component::debugOnOff(newDebugMode);
-            debugMode = newDebugMode;
+            C64Component::powerOn();
+            C64Component::run();
+            state = newState;
             break;
         }
 
-        // Are we requested to change state?
-        while (newState != state) {
+        if (state == EXEC_PAUSED && newState == EXEC_OFF) {
             
-            if (state == EXEC_OFF && newState == EXEC_PAUSED) {
-                
-                C64Component::powerOn();
-                state = newState;
-                break;
-            }
-
-            if (state == EXEC_OFF && newState == EXEC_RUNNING) {
-                
-                C64Component::powerOn();
-                C64Component::run();
-                state = newState;
-                break;
-            }
-
-            if (state == EXEC_PAUSED && newState == EXEC_OFF) {
-                
-                C64Component::powerOff();
-                state = newState;
-                break;
-            }
-
-            if (state == EXEC_PAUSED && newState == EXEC_RUNNING) {
-                
-                C64Component::run();
-                state = newState;
-                break;
-            }
+            C64Component::powerOff();
+            state = newState;
+            break;
+        }
 
-            if (state == EXEC_RUNNING && newState == EXEC_OFF) {
-                
-                C64Component::pause();
-                C64Component::powerOff();
-                state = newState;
-                break;
-            }
+        if (state == EXEC_PAUSED && newState == EXEC_RUNNING) {
+            
+            C64Component::run();
+            state = newState;
+            break;
+        }
 
-            if (state == EXEC_RUNNING && newState == EXEC_PAUSED) {
-                
-                C64Component::pause();
-                state = newState;
-                break;
-            }
+        if (state == EXEC_RUNNING && newState == EXEC_OFF) {
             
-            if (newState == EXEC_HALTED) {
-                
-                C64Component::halt();
-                state = newState;
-                return;
-            }
+            C64Component::pause();
+            C64Component::powerOff();
+            state = newState;
+            break;
+        }
+
+        if (state == EXEC_RUNNING && newState == EXEC_PAUSED) {
             
-            // Invalid state transition
-            fatalError;
+            C64Component::pause();
+            state = newState;
             break;
         }
         
-        // Compute the CPU load once in a while
-        if (loopCounter % 32 == 0) {
-            
-            auto used  = loadClock.getElapsedTime().asSeconds();
-            auto total = nonstopClock.getElapsedTime().asSeconds();
+        if (newState == EXEC_HALTED) {
             
-            cpuLoad = used / total;
-            
-            loadClock.restart();
-            loadClock.stop();
-            nonstopClock.restart();
+            C64Component::halt();
+            state = newState;
+            return false;
         }
+        
+        // Invalid state transition
+        fatalError;
+        break;
+    }
+    
+    return state != EXEC_HALTED;
+}
+
+void
+Thread::updateCpuLoad()
+{
+    auto used  = loadClock.getElapsedTime().asSeconds();
+    auto total = nonstopClock.getElapsedTime().asSeconds();
+    
+    cpuLoad = used / total;
+    
+    loadClock.restart();
+    loadClock.stop();
+    nonstopClock.restart();
+}
+
+bool
+Thread::executeSlice()
+{
+    assert(!threaded);
+    
+    bool result = false;
+    
+    sliceMutex.lock();
+    
+    if (isRunning()) {
+
+        // Resynchronize if we're completely out of sync
+        auto now = util::Time::now();
+        if ((now - targetTime).abs().asMilliseconds() > 200) targetTime = now;
+        targetTime += delay;
+
+        // Call the execution function
+        loadClock.go();
+        execute();
+        loadClock.stop();
+        
+        if (++loopCounter % 32 == 0) updateCpuLoad();
+        result = true;
     }
+    
+    // Carry out state change requests issued by the execution function
+    processRequests();
+    
+    sliceMutex.unlock();
+    return result;
 }
 
 void
@@ -331,6 +375,7 @@ void
 Thread::changeStateTo(ExecutionState requestedState, bool blocking)
 {
     newState = requestedState;
+    if (!threaded) { applyRequests(); return; }
     if (blocking) while (state != newState) { };
 }
 
@@ -338,6 +383,7 @@ void
 Thread::changeWarpTo(bool value, bool blocking)
 {
     newWarpMode = value;
+    if (!threaded) { applyRequests(); return; }
     if (blocking) while (warpMode != newWarpMode) { };
 }
 
@@ -345,9 +391,27 @@ void
 Thread::changeDebugTo(bool value, bool blocking)
 {
     newDebugMode = value;
+    if (!threaded) { applyRequests(); return; }
     if (blocking) while (debugMode != newDebugMode) { };
 }
 
+void
+Thread::applyRequests()
+{
+    assert(!threaded);
+    
+    // Wait until the currently executed slice has been finished
+    sliceMutex.lock();
+    
+    // Reinitialize the sync timer if the emulator is about to run
+    if (newState == EXEC_RUNNING && state != EXEC_RUNNING) {
+        targetTime = util::Time::now();
+    }
+    
+    processRequests();
+    sliceMutex.unlock();
+}
+
 void
 Thread::wakeUp()
 {
@@ -84,6 +84,14 @@
  * closed. In debug mode, several time-consuming tasks are performed that are
  * usually left out. E.g., the CPU checks for breakpoints and records the
  * executed instruction in it's trace buffer.
+ *
+ * If many emulator instances are run inside a single process, a dedicated
+ * thread per instance is a waste of resources. For this use case, an instance
+ * can be created without a thread. Such an instance does not do anything on
+ * it's own. It is driven from the outside by calling executeSlice(), usually
+ * by one of the worker threads of the Scheduler class. In this mode, state
+ * change requests are not handed over to the emulator thread. They are
+ * carried out immediately, after the currently executed slice has finished.
  */
 
 class Thread : public C64Component, util::Wakeable {
@@ -93,6 +101,12 @@ class Thread : public C64Component, util::Wakeable {
     // The thread object
     std::thread thread;
 
+    // Indicates if this instance runs inside it's own thread
+    const bool threaded;
+    
+    // Mutex preventing state changes while a slice is executed (no thread)
+    util::ReentrantMutex sliceMutex;
+
     // The current synchronization mode
     enum class SyncMode { Periodic, Pulsed };
     volatile SyncMode mode = SyncMode::Periodic;
@@ -135,7 +149,7 @@ class Thread : public C64Component, util::Wakeable {
 
 public:
     
-    Thread();
+    Thread(bool threaded = true);
     ~Thread();
     
     const char *getDescription() const override { return "Thread"; }
@@ -153,12 +167,36 @@ private:
     // The main entry point (called when the thread is created)
     void main();
 
+    /* Carries out pending state change requests. The function returns false
+     * if the thread has been halted.
+     */
+    bool processRequests();
+    
+    // Updates the CPU load (called once in a while)
+    void updateCpuLoad();
+
     // The code to be executed in each iteration (implemented by the subclass)
     virtual void execute() = 0;
 
     // Returns true if this functions is called from within the emulator thread
     bool isEmulatorThread() { return std::this_thread::get_id() == thread.get_id(); }
 
+public:
+    
+    // Indicates if this instance is driven from the outside
+    bool isThreaded() const { return threaded; }
+
+    /* Executes a single iteration of the run loop if the emulator is running.
+     * This function must only be called for instances that were created
+     * without a thread. It returns false if the emulator isn't running.
+     */
+    bool executeSlice();
+    
+    /* Returns the point in time at which the next slice is due. In warp mode,
+     * slices are always due immediately.
+     */
+    util::Time nextSlice() const { return warpMode ? util::Time() : targetTime; }
+
     
     //
     // Configuring
@@ -210,6 +248,9 @@ private:
     void changeWarpTo(bool value, bool blocking);
     void changeDebugTo(bool value, bool blocking);
     
+    // Carries out a change request immediately (instances without a thread)
+    void applyRequests();
+    
     
     //
     // Synchronizing
@@ -0,0 +1,599 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "Benchmark.h"
+#include "Headless.h"
+#include "IO.h"
+#include "Checksum.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sys/resource.h>
+
+//
+// Workload data
+//
+
+/* Raster interrupt handler (loaded to $C000 and started with SYS 49152). The
+ * program banks out the Kernal, enables all sprites, and installs an
+ * interrupt handler which is triggered in each of the first 256 rasterlines.
+ * The handler changes the border and background color and moves all sprites
+ * once per frame.
+ */
+static const u8 rasterPrg[] = {
+
+    0x00, 0xC0,                     // Load address
+    0x78,                           // C000: SEI
+    0xA9, 0x35,                     // C001: LDA #$35
+    0x85, 0x01,                     // C003: STA $01
+    0xA9, 0x7F,                     // C005: LDA #$7F
+    0x8D, 0x0D, 0xDC,               // C007: STA $DC0D
+    0x8D, 0x0D, 0xDD,               // C00A: STA $DD0D
+    0xAD, 0x0D, 0xDC,               // C00D: LDA $DC0D
+    0xAD, 0x0D, 0xDD,               // C010: LDA $DD0D
+    0xA9, 0x01,                     // C013: LDA #$01
+    0x8D, 0x1A, 0xD0,               // C015: STA $D01A
+    0xA9, 0x1B,                     // C018: LDA #$1B
+    0x8D, 0x11, 0xD0,               // C01A: STA $D011
+    0xA9, 0x00,                     // C01D: LDA #$00
+    0x8D, 0x12, 0xD0,               // C01F: STA $D012
+    0xA9, 0x40,                     // C022: LDA #$40
+    0x8D, 0xFE, 0xFF,               // C024: STA $FFFE
+    0xA9, 0xC0,                     // C027: LDA #$C0
+    0x8D, 0xFF, 0xFF,               // C029: STA $FFFF
+    0xA9, 0x70,                     // C02C: LDA #$70
+    0x8D, 0xFA, 0xFF,               // C02E: STA $FFFA
+    0xA9, 0xC0,                     // C031: LDA #$C0
+    0x8D, 0xFB, 0xFF,               // C033: STA $FFFB
+    0xA9, 0xFF,                     // C036: LDA #$FF
+    0x8D, 0x15, 0xD0,               // C038: STA $D015
+    0x58,                           // C03B: CLI
+    0x4C, 0x3C, 0xC0,               // C03C: JMP $C03C
+    0xEA,                           // C03F: NOP
+    0x48,                           // C040: PHA
+    0x8A,                           // C041: TXA
+    0x48,                           // C042: PHA
+    0xEE, 0x20, 0xD0,               // C043: INC $D020
+    0xEE, 0x21, 0xD0,               // C046: INC $D021
+    0xAD, 0x12, 0xD0,               // C049: LDA $D012
+    0x18,                           // C04C: CLC
+    0x69, 0x01,                     // C04D: ADC #$01
+    0x8D, 0x12, 0xD0,               // C04F: STA $D012
+    0xD0, 0x0C,                     // C052: BNE $C060
+    0xA2, 0x0E,                     // C054: LDX #$0E
+    0xFE, 0x00, 0xD0,               // C056: INC $D000,X
+    0xFE, 0x01, 0xD0,               // C059: INC $D001,X
+    0xCA,                           // C05C: DEX
+    0xCA,                           // C05D: DEX
+    0x10, 0xF6,                     // C05E: BPL $C056
+    0x0E, 0x19, 0xD0,               // C060: ASL $D019
+    0x68,                           // C063: PLA
+    0xAA,                           // C064: TAX
+    0x68,                           // C065: PLA
+    0x40,                           // C066: RTI
+    0xEA, 0xEA, 0xEA, 0xEA, 0xEA,   // C067: NOP (5x)
+    0xEA, 0xEA, 0xEA, 0xEA,         // C06C: NOP (4x)
+    0x40                            // C070: RTI
+};
+
+/* EasyFlash boot code (stored at the beginning of Rom bank 0H which shows up
+ * at $E000 in Ultimax mode). The program cycles through the first eight Rom
+ * banks and copies two pages of each bank to the screen.
+ */
+static const u8 easyFlashBoot[] = {
+
+    0x78,                           // E000: SEI
+    0xA2, 0xFF,                     // E001: LDX #$FF
+    0x9A,                           // E003: TXS
+    0xD8,                           // E004: CLD
+    0xA9, 0x1B,                     // E005: LDA #$1B
+    0x8D, 0x11, 0xD0,               // E007: STA $D011
+    0xA9, 0x14,                     // E00A: LDA #$14
+    0x8D, 0x18, 0xD0,               // E00C: STA $D018
+    0xA0, 0x00,                     // E00F: LDY #$00
+    0x8C, 0x00, 0xDE,               // E011: STY $DE00
+    0xA2, 0x00,                     // E014: LDX #$00
+    0xBD, 0x00, 0x80,               // E016: LDA $8000,X
+    0x9D, 0x00, 0x04,               // E019: STA $0400,X
+    0xBD, 0x00, 0x81,               // E01C: LDA $8100,X
+    0x9D, 0x00, 0x05,               // E01F: STA $0500,X
+    0xE8,                           // E022: INX
+    0xD0, 0xF1,                     // E023: BNE $E016
+    0x8C, 0x20, 0xD0,               // E025: STY $D020
+    0xC8,                           // E028: INY
+    0x98,                           // E029: TYA
+    0x29, 0x07,                     // E02A: AND #$07
+    0xA8,                           // E02C: TAY
+    0xAD, 0x12, 0xD0,               // E02D: LDA $D012
+    0xD0, 0xFB,                     // E030: BNE $E02D
+    0x4C, 0x11, 0xE0,               // E032: JMP $E011
+    0x40                            // E035: RTI
+};
+
+static const char *basicPrg =
+"10 poke 1024+rnd(1)*1000,rnd(1)*256:poke 53280,rnd(1)*16:goto 10\n"
+"run\n";
+
+/* CPU loop (position independent). The program mixes several addressing
+ * modes and is run on the C64 CPU at $C000 and on the drive CPU at $0300.
+ */
+static const u8 cpuLoop[] = {
+
+    0x78,                           // 00: SEI
+    0xA9, 0x00,                     // 01: LDA #$00
+    0x85, 0xFB,                     // 03: STA $FB
+    0xA9, 0x02,                     // 05: LDA #$02
+    0x85, 0xFC,                     // 07: STA $FC
+    0xA0, 0x00,                     // 09: LDY #$00
+    0xA2, 0x00,                     // 0B: LDX #$00
+    0xBD, 0x00, 0x02,               // 0D: LDA $0200,X
+    0x69, 0x01,                     // 10: ADC #$01
+    0x9D, 0x00, 0x02,               // 12: STA $0200,X
+    0x51, 0xFB,                     // 15: EOR ($FB),Y
+    0x06, 0xFD,                     // 17: ASL $FD
+    0x48,                           // 19: PHA
+    0x68,                           // 1A: PLA
+    0xE8,                           // 1B: INX
+    0xD0, 0xEF,                     // 1C: BNE $0D
+    0xC8,                           // 1E: INY
+    0xB8,                           // 1F: CLV
+    0x50, 0xE9                      // 20: BVC $0B
+};
+
+/* SID register setup for the synthesis workloads. All three voices play a
+ * different waveform and are routed through the low-pass filter.
+ */
+static const u8 sidRegs[][2] = {
+
+    { 0x00, 0x00 }, { 0x01, 0x11 }, { 0x03, 0x08 },     // Voice 1 (pulse)
+    { 0x05, 0x09 }, { 0x06, 0xF0 }, { 0x04, 0x41 },
+    { 0x07, 0x00 }, { 0x08, 0x16 },                     // Voice 2 (sawtooth)
+    { 0x0C, 0x09 }, { 0x0D, 0xF0 }, { 0x0B, 0x21 },
+    { 0x0E, 0x00 }, { 0x0F, 0x1C },                     // Voice 3 (triangle)
+    { 0x13, 0x09 }, { 0x14, 0xF0 }, { 0x12, 0x11 },
+    { 0x15, 0x00 }, { 0x16, 0x40 },                     // Filter
+    { 0x17, 0xF7 }, { 0x18, 0x1F }
+};
+
+static const char *multiSidPrg =
+"10 for s=54272 to 54368 step 32:poke s+24,15:poke s+5,9:poke s+6,240\n"
+"20 poke s+4,33:next\n"
+"30 for s=54272 to 54368 step 32:poke s+1,rnd(1)*256:next:goto 30\n"
+"run\n";
+
+
+//
+// Peak memory usage
+//
+
+// Returns the peak resident set size of this process in KB
+static isize
+peakRSS()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+    return (isize)usage.ru_maxrss / 1024;
+#else
+    return (isize)usage.ru_maxrss;
+#endif
+}
+
+// Resets the peak resident set size (if supported by the host)
+static void
+resetPeakRSS()
+{
+#ifdef __linux__
+    std::ofstream stream("/proc/self/clear_refs");
+    if (stream.is_open()) stream << "5";
+#endif
+}
+
+// Returns the peak resident set size since the last reset in KB
+static isize
+currentPeakRSS()
+{
+#ifdef __linux__
+    std::ifstream stream("/proc/self/status");
+    string line;
+
+    while (std::getline(stream, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return (isize)std::stol(line.substr(6));
+    }
+#endif
+    return peakRSS();
+}
+
+
+//
+// Benchmark
+//
+
+Benchmark::Benchmark(const std::vector<string> &roms, C64Model model, isize frames) :
+roms(roms), model(model), frames(frames)
+{
+
+}
+
+int
+Benchmark::run()
+{
+    static const Scenario scenarios[] = {
+
+        { "BASIC loop",     &Benchmark::none,               &Benchmark::launchBasic,    false },
+        { "Raster IRQs",    &Benchmark::none,               &Benchmark::launchRaster,   false },
+        { "Disk load",      &Benchmark::configureDisk,      &Benchmark::launchDisk,     true  },
+        { "4-SID reSID",    &Benchmark::configureMultiSid,  &Benchmark::launchMultiSid, false },
+        { "EasyFlash",      &Benchmark::configureEasyFlash, &Benchmark::none,           false }
+    };
+
+    std::vector<Result> results;
+    for (auto &scenario : scenarios) results.push_back(run(scenario));
+    results.push_back(runCpu("CPU (C64)", false));
+    results.push_back(runCpu("CPU (VC1541)", true));
+
+    report(results);
+
+    auto kernel = reSID::SID::best_convolution_kernel();
+
+    std::vector<SidResult> sidResults;
+    sidResults.push_back(runSid(reSID::SAMPLE_FAST, kernel));
+    sidResults.push_back(runSid(reSID::SAMPLE_INTERPOLATE, kernel));
+    sidResults.push_back(runSid(reSID::SAMPLE_RESAMPLE, kernel));
+    if (kernel != reSID::SID::CONVOLVE_SCALAR) {
+        sidResults.push_back(runSid(reSID::SAMPLE_RESAMPLE, reSID::SID::CONVOLVE_SCALAR));
+    }
+
+    std::cout << std::endl;
+    report(sidResults);
+
+    for (auto &result : results) {
+        if (result.jammed) return headless::CPU_JAMMED;
+    }
+    return headless::OK;
+}
+
+Benchmark::Result
+Benchmark::run(const Scenario &scenario)
+{
+    Result result = { scenario.name, false, false, 0, 0, 0.0, 0.0, 0 };
+
+    // Make each run start from the same state
+    srand(0);
+    resetPeakRSS();
+    cpuJammed = false;
+
+    C64 c64(false);
+    c64.msgQueue.setListener(this, process);
+    c64.configure(model);
+
+    for (auto &path : roms) {
+
+        if (!util::fileExists(path)) throw VC64Error(ERROR_FILE_NOT_FOUND, path);
+        c64.loadRom(path);
+    }
+
+    if (scenario.needsDriveRom && !c64.hasRom(ROM_TYPE_VC1541)) {
+
+        result.skipped = true;
+        return result;
+    }
+
+    c64.warpOn();
+    c64.setWarpLock(true);
+
+    (this->*scenario.configure)(c64);
+    c64.powerOn();
+
+    // Let the Kernal initialize the machine and launch the workload
+    c64.executeFrames(bootFrames);
+    (this->*scenario.launch)(c64);
+    c64.executeFrames(warmupFrames);
+
+    // Run the timed part
+    u64 firstFrame = c64.frame;
+    Cycle firstCycle = c64.cpu.cycle;
+    util::Clock clock;
+
+    c64.executeFrames(frames);
+
+    result.seconds = clock.stop().asSeconds();
+    result.frames = (isize)(c64.frame - firstFrame);
+    result.cycles = c64.cpu.cycle - firstCycle;
+    result.emulated = result.frames / c64.vic.getFps();
+    result.peakRSS = currentPeakRSS();
+    result.jammed = cpuJammed;
+
+    c64.halt();
+    return result;
+}
+
+Benchmark::Result
+Benchmark::runCpu(const char *name, bool drive)
+{
+    Result result = { name, false, false, 0, 0, 0.0, 0.0, 0 };
+
+    resetPeakRSS();
+    cpuJammed = false;
+
+    C64 c64(false);
+    c64.msgQueue.setListener(this, process);
+    c64.configure(model);
+
+    // Install the program in Ram
+    u16 start = drive ? 0x0300 : 0xC000;
+    for (isize i = 0; i < isizeof(cpuLoop); i++) {
+        
+        if (drive) {
+            c64.drive8.mem.poke((u16)(start + i), cpuLoop[i]);
+        } else {
+            c64.mem.poke((u16)(start + i), cpuLoop[i]);
+        }
+    }
+
+    // Run the CPU in isolation
+    auto execute = [&](auto &cpu) {
+
+        cpu.jumpToAddress(start);
+        
+        util::Clock clock;
+        for (Cycle i = 0; i < cpuCycles; i++) cpu.executeOneCycle();
+        result.seconds = clock.stop().asSeconds();
+        result.jammed = cpu.isJammed();
+    };
+    drive ? execute(c64.drive8.cpu) : execute(c64.cpu);
+
+    result.cycles = cpuCycles;
+    result.emulated = (double)cpuCycles / c64.vic.getFrequency();
+    result.peakRSS = currentPeakRSS();
+
+    return result;
+}
+
+Benchmark::SidResult
+Benchmark::runSid(reSID::sampling_method method, reSID::SID::convolution_kernel kernel)
+{
+    SidResult result = { "", 0, sidCycles, 0.0, 0 };
+
+    switch (method) {
+
+        case reSID::SAMPLE_FAST:        result.name = "Fast"; break;
+        case reSID::SAMPLE_INTERPOLATE: result.name = "Interpolate"; break;
+        default:
+            result.name = string("Resample (") +
+            reSID::SID::convolution_kernel_name(kernel) + ")";
+    }
+
+    reSID::SID sid;
+    sid.set_chip_model(reSID::MOS8580);
+    sid.set_sampling_parameters((double)PAL_CLOCK_FREQUENCY, method, 44100.0);
+    sid.set_convolution_kernel(kernel);
+    for (auto &reg : sidRegs) sid.write(reg[0], reg[1]);
+
+    short buffer[4096];
+    u64 checksum = util::fnv_1a_init64();
+    util::Clock clock;
+
+    for (Cycle remaining = sidCycles; remaining > 0;) {
+
+        reSID::cycle_count delta = (reSID::cycle_count)std::min(remaining, (Cycle)20000);
+        remaining -= delta;
+
+        while (delta) {
+
+            int count = sid.clock(delta, buffer, 4096);
+            for (int i = 0; i < count; i++) checksum = util::fnv_1a_it64(checksum, (u16)buffer[i]);
+            result.samples += count;
+        }
+    }
+
+    result.seconds = clock.stop().asSeconds();
+    result.checksum = checksum;
+    return result;
+}
+
+void
+Benchmark::report(const std::vector<Result> &results)
+{
+    auto &os = std::cout;
+
+    os << std::left << std::setw(16) << "Workload";
+    os << std::right << std::setw(10) << "Frames";
+    os << std::setw(12) << "Frames/s";
+    os << std::setw(14) << "Cycles/s";
+    os << std::setw(10) << "Speed";
+    os << std::setw(14) << "Peak RSS" << std::endl;
+
+    for (auto &result : results) {
+
+        os << std::left << std::setw(16) << result.name << std::right;
+
+        if (result.skipped) {
+
+            os << std::setw(10) << "skipped" << std::endl;
+            continue;
+        }
+
+        auto fps = result.seconds > 0 ? result.frames / result.seconds : 0.0;
+        auto cps = result.seconds > 0 ? result.cycles / result.seconds : 0.0;
+        auto speed = result.seconds > 0 ? result.emulated / result.seconds : 0.0;
+
+        if (result.frames) {
+
+            os << std::setw(10) << result.frames;
+            os << std::setw(12) << std::fixed << std::setprecision(1) << fps;
+
+        } else {
+
+            os << std::setw(10) << "-" << std::setw(12) << "-" << std::fixed;
+        }
+        os << std::setw(14) << std::setprecision(0) << cps;
+        os << std::setw(9) << std::setprecision(2) << speed << "x";
+        os << std::setw(11) << result.peakRSS << " KB";
+        if (result.jammed) os << "  (CPU jammed)";
+        os << std::endl;
+    }
+    os << std::defaultfloat;
+}
+
+
+void
+Benchmark::report(const std::vector<SidResult> &results)
+{
+    auto &os = std::cout;
+
+    os << std::left << std::setw(22) << "SID synthesis";
+    os << std::right << std::setw(10) << "Samples";
+    os << std::setw(14) << "Samples/s";
+    os << std::setw(14) << "Cycles/s";
+    os << std::setw(10) << "Speed" << std::endl;
+
+    const SidResult *reference = nullptr;
+
+    for (auto &result : results) {
+
+        auto sps = result.seconds > 0 ? result.samples / result.seconds : 0.0;
+        auto cps = result.seconds > 0 ? result.cycles / result.seconds : 0.0;
+        auto speed = cps / PAL_CLOCK_FREQUENCY;
+
+        os << std::left << std::setw(22) << result.name << std::right;
+        os << std::setw(10) << result.samples;
+        os << std::setw(14) << std::fixed << std::setprecision(0) << sps;
+        os << std::setw(14) << cps;
+        os << std::setw(9) << std::setprecision(2) << speed << "x";
+
+        // All convolution kernels must produce the same samples
+        if (result.name.rfind("Resample", 0) == 0) {
+
+            if (!reference) reference = &result;
+            if (reference->checksum != result.checksum) {
+                os << "  (output differs from " << reference->name << ")";
+            }
+        }
+        os << std::endl;
+    }
+    os << std::defaultfloat;
+}
+
+
+//
+// Workloads
+//
+
+void
+Benchmark::launchBasic(C64 &c64)
+{
+    c64.keyboard.autoType(basicPrg);
+}
+
+void
+Benchmark::launchRaster(C64 &c64)
+{
+    PRGFile prg(rasterPrg, sizeof(rasterPrg));
+
+    c64.flash(prg, 0);
+    c64.keyboard.autoType("sys 49152\n");
+}
+
+void
+Benchmark::configureDisk(C64 &c64)
+{
+    // Create a 24 KB program which is loaded to $2000
+    std::vector<u8> data(2 + 0x6000);
+    data[0] = 0x00;
+    data[1] = 0x20;
+    for (usize i = 2; i < data.size(); i++) data[i] = (u8)(i * 7);
+
+    PRGFile prg(data.data(), (isize)data.size());
+    FSDevice fs(prg);
+
+    c64.drive8.insertFileSystem(fs, false);
+}
+
+void
+Benchmark::launchDisk(C64 &c64)
+{
+    c64.keyboard.autoType("load\"*\",8,1\n");
+}
+
+void
+Benchmark::configureMultiSid(C64 &c64)
+{
+    c64.configure(OPT_SID_ENGINE, SIDENGINE_RESID);
+
+    for (isize i = 1; i < 4; i++) c64.configure(OPT_SID_ENABLE, i, true);
+}
+
+void
+Benchmark::launchMultiSid(C64 &c64)
+{
+    c64.keyboard.autoType(multiSidPrg);
+}
+
+void
+Benchmark::configureEasyFlash(C64 &c64)
+{
+    std::vector<u8> data;
+
+    auto write8 = [&](u8 value) { data.push_back(value); };
+    auto write16 = [&](u16 value) { write8(HI_BYTE(value)); write8(LO_BYTE(value)); };
+    auto write32 = [&](u32 value) { write16(HI_WORD(value)); write16(LO_WORD(value)); };
+
+    auto writeChip = [&](u16 bank, u16 addr, const u8 *rom) {
+        for (auto c : string("CHIP")) write8(c);
+        write32(0x2010);
+        write16(0x0002);
+        write16(bank);
+        write16(addr);
+        write16(0x2000);
+        data.insert(data.end(), rom, rom + 0x2000);
+    };
+
+    // Header (EasyFlash, Ultimax mode)
+    for (auto c : string("C64 CARTRIDGE   ")) write8(c);
+    write32(0x40);
+    write16(0x0100);
+    write16(CRT_EASYFLASH);
+    write8(1);
+    write8(0);
+    data.resize(0x40, 0);
+
+    // Rom banks 0L to 7L contain the data to display
+    u8 rom[0x2000];
+    for (u16 bank = 0; bank < 8; bank++) {
+
+        for (isize i = 0; i < 0x2000; i++) rom[i] = (u8)(bank * 31 + i * 7);
+        writeChip(bank, 0x8000, rom);
+    }
+
+    // Rom bank 0H contains the boot code and the processor vectors
+    memset(rom, 0xFF, sizeof(rom));
+    memcpy(rom, easyFlashBoot, sizeof(easyFlashBoot));
+    rom[0x1FFA] = 0x35; rom[0x1FFB] = 0xE0;
+    rom[0x1FFC] = 0x00; rom[0x1FFD] = 0xE0;
+    rom[0x1FFE] = 0x35; rom[0x1FFF] = 0xE0;
+    writeChip(0, 0xA000, rom);
+
+    CRTFile crt(data.data(), (isize)data.size());
+    c64.expansionport.attachCartridge(&crt, false);
+}
+
+
+//
+// Processing messages
+//
+
+void
+Benchmark::process(const void *listener, long type, long data)
+{
+    if (type == MSG_CPU_JAMMED) ((Benchmark *)listener)->cpuJammed = true;
+}
@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "C64.h"
+
+#include <vector>
+
+/* The benchmark suite measures the emulation speed for a fixed set of
+ * workloads. It is launched by calling the headless runner with option
+ * --benchmark (or via the 'bench' target of the Makefile).
+ *
+ * All workloads are built into the suite. Hence, the results only depend on
+ * the installed Rom images and the number of emulated frames. For each
+ * workload, a fresh emulator instance is created, booted, and prepared. After
+ * that, the requested number of frames is emulated in warp mode and timed.
+ *
+ * Workloads that cannot be run with the installed Roms (e.g., the disk
+ * workload without a VC1541 Rom) are reported as skipped.
+ *
+ * In addition, the suite runs a machine code loop on the C64 CPU and on the
+ * drive CPU in isolation. These workloads clock nothing but the CPU and
+ * measure the raw speed of the microinstruction dispatcher.
+ *
+ * Finally, a single reSID instance is run in isolation with each sampling
+ * method to measure the speed of sample synthesis. Resampling is measured
+ * with the FIR convolution kernel selected for the host CPU and with the
+ * scalar kernel. Both runs must produce the same samples.
+ */
+class Benchmark {
+
+    struct Scenario {
+
+        // Name of the workload as printed in the report
+        const char *name;
+
+        // Configures the instance before it is powered on
+        void (Benchmark::*configure)(C64 &c64);
+
+        // Launches the workload after the Kernal has booted
+        void (Benchmark::*launch)(C64 &c64);
+
+        // Indicates if the workload requires a VC1541 Rom
+        bool needsDriveRom;
+    };
+
+    struct Result {
+
+        const char *name;
+        bool skipped;
+        bool jammed;
+        isize frames;
+        Cycle cycles;
+        double seconds;
+        double emulated;
+        isize peakRSS;
+    };
+
+    struct SidResult {
+
+        string name;
+        isize samples;
+        Cycle cycles;
+        double seconds;
+        u64 checksum;
+    };
+
+    // Rom images to install
+    std::vector<string> roms;
+
+    // The emulated C64 model
+    C64Model model;
+
+    // Number of frames to emulate in each workload
+    isize frames;
+
+    // Number of frames to emulate before the workload is launched
+    static constexpr isize bootFrames = 150;
+
+    // Number of untimed frames after the workload has been launched
+    static constexpr isize warmupFrames = 50;
+
+    // Number of cycles to emulate in each CPU workload
+    static constexpr Cycle cpuCycles = 50000000;
+
+    // Number of cycles to emulate in each SID workload
+    static constexpr Cycle sidCycles = 10000000;
+
+    // Set by the message queue callback
+    bool cpuJammed = false;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    Benchmark(const std::vector<string> &roms, C64Model model, isize frames);
+
+
+    //
+    // Running
+    //
+
+public:
+
+    // Runs all workloads and prints the report
+    int run() throws;
+
+private:
+
+    // Runs a single workload
+    Result run(const Scenario &scenario) throws;
+
+    // Runs the CPU loop on the C64 CPU or the drive CPU of the first drive
+    Result runCpu(const char *name, bool drive) throws;
+
+    // Runs a single reSID instance with the given sampling method and kernel
+    SidResult runSid(reSID::sampling_method method,
+                     reSID::SID::convolution_kernel kernel);
+
+    // Prints the report
+    void report(const std::vector<Result> &results);
+    void report(const std::vector<SidResult> &results);
+
+
+    //
+    // Workloads
+    //
+
+private:
+
+    // Does nothing (used for workloads without a setup step)
+    void none(C64 &c64) { }
+
+    // A BASIC program drawing random characters in an endless loop
+    void launchBasic(C64 &c64);
+
+    // A machine code program triggering a raster interrupt in each line
+    void launchRaster(C64 &c64);
+
+    // A program that is loaded from disk with true drive emulation
+    void configureDisk(C64 &c64);
+    void launchDisk(C64 &c64);
+
+    // A BASIC program playing random notes on four reSID instances
+    void configureMultiSid(C64 &c64);
+    void launchMultiSid(C64 &c64);
+
+    // An EasyFlash cartridge cycling through its Rom banks
+    void configureEasyFlash(C64 &c64);
+
+
+    //
+    // Processing messages
+    //
+
+    static void process(const void *listener, long type, long data);
+};
@@ -23,7 +23,7 @@ static_assert(sizeof(u16) == 2, "u16 size mismatch");
 static_assert(sizeof(u32) == 4, "u32 size mismatch");
 static_assert(sizeof(u64) == 8, "u64 size mismatch");
 
-C64::C64()
+C64::C64(bool threaded) : SuspendableThread(threaded)
 {
     trace(RUN_DEBUG, "Creating virtual C64\n");
         
@@ -47,6 +47,8 @@ C64::C64()
         &retroShell,
         &regressionTester,
         &recorder,
+        &rewindBuffer,
+        &profiler,
         &msgQueue
     };
 
@@ -58,6 +60,9 @@ C64::C64()
 C64::~C64()
 {
     trace(RUN_DEBUG, "Destroying C64\n");
+    
+    delete autoSnapshot;
+    delete userSnapshot;
 }
 
 void
@@ -112,6 +117,7 @@ C64::getConfigItem(Option option) const
         case OPT_VIC_REVISION:
         case OPT_VIC_SPEED:
         case OPT_VIC_POWER_SAVE:
+        case OPT_VIC_RGBA_OUTPUT:
         case OPT_GRAY_DOT_BUG:
         case OPT_GLUE_LOGIC:
         case OPT_HIDE_SPRITES:
@@ -144,6 +150,7 @@ C64::getConfigItem(Option option) const
         case OPT_SID_FILTER:
         case OPT_SID_ENGINE:
         case OPT_SID_SAMPLING:
+        case OPT_SID_ASYNC:
         case OPT_AUDVOLL:
         case OPT_AUDVOLR:
             return muxer.getConfigItem(option);
@@ -151,6 +158,10 @@ C64::getConfigItem(Option option) const
         case OPT_RAM_PATTERN:
             return mem.getConfigItem(option);
             
+        case OPT_REWIND_INTERVAL:
+        case OPT_REWIND_BUDGET:
+            return rewindBuffer.getConfigItem(option);
+            
         default:
             fatalError;
     }
@@ -182,6 +193,7 @@ C64::getConfigItem(Option option, long id) const
         case OPT_DRV_RAM:
         case OPT_DRV_PARCABLE:
         case OPT_DRV_POWER_SAVE:
+        case OPT_DRV_ACCELERATE:
         case OPT_DRV_POWER_SWITCH:
         case OPT_DRV_EJECT_DELAY:
         case OPT_DRV_SWAP_DELAY:
@@ -254,6 +266,7 @@ C64::configure(Option option, i64 value)
         case OPT_SATURATION:
         case OPT_GRAY_DOT_BUG:
         case OPT_VIC_POWER_SAVE:
+        case OPT_VIC_RGBA_OUTPUT:
         case OPT_HIDE_SPRITES:
         case OPT_SS_COLLISIONS:
         case OPT_SB_COLLISIONS:
@@ -313,6 +326,7 @@ C64::configure(Option option, i64 value)
         case OPT_SID_SAMPLING:
         case OPT_SID_POWER_SAVE:
         case OPT_SID_ENGINE:
+        case OPT_SID_ASYNC:
         case OPT_AUDPAN:
         case OPT_AUDVOL:
         case OPT_AUDVOLL:
@@ -326,6 +340,12 @@ C64::configure(Option option, i64 value)
             mem.setConfigItem(option, value);
             break;
 
+        case OPT_REWIND_INTERVAL:
+        case OPT_REWIND_BUDGET:
+            
+            rewindBuffer.setConfigItem(option, value);
+            break;
+
         case OPT_DRV_AUTO_CONFIG:
         case OPT_DRV_TYPE:
         case OPT_DRV_RAM:
@@ -333,6 +353,7 @@ C64::configure(Option option, i64 value)
         case OPT_DRV_CONNECT:
         case OPT_DRV_POWER_SWITCH:
         case OPT_DRV_POWER_SAVE:
+        case OPT_DRV_ACCELERATE:
         case OPT_DRV_EJECT_DELAY:
         case OPT_DRV_SWAP_DELAY:
         case OPT_DRV_INSERT_DELAY:
@@ -442,6 +463,7 @@ C64::configure(Option option, long id, i64 value)
         case OPT_DRV_CONNECT:
         case OPT_DRV_POWER_SWITCH:
         case OPT_DRV_POWER_SAVE:
+        case OPT_DRV_ACCELERATE:
         case OPT_DRV_EJECT_DELAY:
         case OPT_DRV_SWAP_DELAY:
         case OPT_DRV_INSERT_DELAY:
@@ -602,61 +624,133 @@ C64::execute()
     executeOneFrame();
     
     // Check if special action needs to be taken
-    if (flags) {
-        
-        // Are we requested to take a snapshot?
-        if (flags & RL::AUTO_SNAPSHOT) {
-            clearFlag(RL::AUTO_SNAPSHOT);
-            autoSnapshot = new Snapshot(*this);
-            msgQueue.put(MSG_AUTO_SNAPSHOT_TAKEN);
-        }
-        if (flags & RL::USER_SNAPSHOT) {
-            clearFlag(RL::USER_SNAPSHOT);
-            userSnapshot = new Snapshot(*this);
-            msgQueue.put(MSG_USER_SNAPSHOT_TAKEN);
-        }
-        
-        // Are we requested to update the debugger info structs?
-        if (flags & RL::INSPECT) {
-            clearFlag(RL::INSPECT);
-            inspect();
-        }
-        
-        // Did we reach a breakpoint?
-        if (flags & RL::BREAKPOINT) {
-            clearFlag(RL::BREAKPOINT);
-            msgQueue.put(MSG_BREAKPOINT_REACHED, cpu.debugger.breakpointPC);
-            newState = EXEC_PAUSED;
-        }
+    if (flags) processFlags();
+}
+
+isize
+C64::executeFrames(isize count)
+{
+    assert(!isRunning());
+    
+    cpu.debugger.watchpointPC = -1;
+    cpu.debugger.breakpointPC = -1;
+
+    u64 first = frame;
+    u64 last = frame + count;
+    
+    while (frame < last) {
         
-        // Did we reach a watchpoint?
-        if (flags & RL::WATCHPOINT) {
-            clearFlag(RL::WATCHPOINT);
-            msgQueue.put(MSG_WATCHPOINT_REACHED, cpu.debugger.watchpointPC);
-            newState = EXEC_PAUSED;
-        }
+        // Run the emulator
+        executeOneFrame();
         
-        // Are we requested to terminate the run loop?
-        if (flags & RL::STOP) {
-            clearFlag(RL::STOP);
-            newState = EXEC_PAUSED;
-        }
+        // Check if special action needs to be taken
+        if (flags && processFlags()) break;
+    }
+    
+    return (isize)(frame - first);
+}
+
+Cycle
+C64::fastForward(Cycle cycle)
+{
+    assert(!isRunning());
+    
+    cpu.debugger.watchpointPC = -1;
+    cpu.debugger.breakpointPC = -1;
+    
+    Cycle first = (Cycle)cpu.cycle;
+    
+    // Enter fast-forward mode
+    fastForwardMode = true;
+    vic.updateVicFunctionTable();
+    
+    while ((Cycle)cpu.cycle < cycle) {
         
-        // Are we requested to pull the NMI line down?
-        if (flags & RL::EXTERNAL_NMI) {
-            clearFlag(RL::EXTERNAL_NMI);
-            cpu.pullDownNmiLine(INTSRC_EXP);
+        // Emulate line by line until the target cycle is within reach
+        if (rasterCycle == 1 && (Cycle)cpu.cycle + vic.getCyclesPerLine() <= cycle) {
+            executeOneLine();
+        } else {
+            executeOneCycle();
         }
         
-        // Is the CPU jammed due the execution of an illegal instruction?
-        if (flags & RL::CPU_JAM) {
-            clearFlag(RL::CPU_JAM);
-            msgQueue.put(MSG_CPU_JAMMED);
-            newState = EXEC_PAUSED;
-        }
-                    
-        assert(flags == 0);
+        // Check if special action needs to be taken
+        if (flags && processFlags()) break;
+    }
+    
+    // Leave fast-forward mode
+    fastForwardMode = false;
+    vic.updateVicFunctionTable();
+    
+    // Draw the remaining lines of the current frame again
+    vic.updateHeadlessMode();
+    
+    return (Cycle)cpu.cycle - first;
+}
+
+bool
+C64::processFlags()
+{
+    bool stop = false;
+    
+    // Are we requested to take a snapshot?
+    if (flags & RL::AUTO_SNAPSHOT) {
+        clearFlag(RL::AUTO_SNAPSHOT);
+        delete autoSnapshot;
+        autoSnapshot = new Snapshot(*this);
+        msgQueue.put(MSG_AUTO_SNAPSHOT_TAKEN);
+    }
+    if (flags & RL::USER_SNAPSHOT) {
+        clearFlag(RL::USER_SNAPSHOT);
+        delete userSnapshot;
+        userSnapshot = new Snapshot(*this);
+        msgQueue.put(MSG_USER_SNAPSHOT_TAKEN);
+    }
+    
+    // Are we requested to update the debugger info structs?
+    if (flags & RL::INSPECT) {
+        clearFlag(RL::INSPECT);
+        inspect();
+    }
+    
+    // Did we reach a breakpoint?
+    if (flags & RL::BREAKPOINT) {
+        clearFlag(RL::BREAKPOINT);
+        msgQueue.put(MSG_BREAKPOINT_REACHED, cpu.debugger.breakpointPC);
+        newState = EXEC_PAUSED;
+        stop = true;
+    }
+    
+    // Did we reach a watchpoint?
+    if (flags & RL::WATCHPOINT) {
+        clearFlag(RL::WATCHPOINT);
+        msgQueue.put(MSG_WATCHPOINT_REACHED, cpu.debugger.watchpointPC);
+        newState = EXEC_PAUSED;
+        stop = true;
+    }
+    
+    // Are we requested to terminate the run loop?
+    if (flags & RL::STOP) {
+        clearFlag(RL::STOP);
+        newState = EXEC_PAUSED;
+        stop = true;
+    }
+    
+    // Are we requested to pull the NMI line down?
+    if (flags & RL::EXTERNAL_NMI) {
+        clearFlag(RL::EXTERNAL_NMI);
+        cpu.pullDownNmiLine(INTSRC_EXP);
     }
+    
+    // Is the CPU jammed due the execution of an illegal instruction?
+    if (flags & RL::CPU_JAM) {
+        clearFlag(RL::CPU_JAM);
+        msgQueue.put(MSG_CPU_JAMMED);
+        newState = EXEC_PAUSED;
+        stop = true;
+    }
+    
+    assert(flags == 0);
+    return stop;
 }
 
 void
@@ -833,6 +927,9 @@ C64::stepOver()
 void
 C64::executeOneFrame()
 {
+    // Don't charge the time that has passed since the last frame
+    if (CYCLE_PROFILER) profiler.resume();
+    
     do { executeOneLine(); } while (scanline != 0 && flags == 0);
 }
 
@@ -892,16 +989,23 @@ C64::_executeOneCycle()
     // '-------------------------------------|-------------------|--'
     
     // First clock phase (o2 low)
+    if (CYCLE_PROFILER) profiler.enter(PROF_VICII);
     (vic.*vic.vicfunc[rasterCycle])();
+    if (CYCLE_PROFILER) profiler.enter(PROF_CIA);
     if (cycle >= cia1.wakeUpCycle) cia1.executeOneCycle();
     if (cycle >= cia2.wakeUpCycle) cia2.executeOneCycle();
+    if (CYCLE_PROFILER) profiler.enter(PROF_IEC);
     if (iec.isDirtyC64Side) iec.updateIecLinesC64Side();
     
     // Second clock phase (o2 high)
+    if (CYCLE_PROFILER) profiler.enter(PROF_CPU);
     cpu.executeOneCycle();
+    if (CYCLE_PROFILER) profiler.enter(PROF_DRIVE);
     if (drive8.needsEmulation) drive8.execute(nativeDurationOfOneCycle);
     if (drive9.needsEmulation) drive9.execute(nativeDurationOfOneCycle);
+    if (CYCLE_PROFILER) profiler.enter(PROF_DATASETTE);
     datasette.execute();
+    if (CYCLE_PROFILER) profiler.enter(PROF_OTHER);
     
     rasterCycle++;
 }
@@ -961,7 +1065,9 @@ C64::endFrame()
     drive9.vsyncHandler();
     datasette.vsyncHandler();
     retroShell.vsyncHandler();
-    recorder.vsyncHandler();    
+    if (!fastForwardMode) recorder.vsyncHandler();
+    rewindBuffer.vsyncHandler();
+    if (CYCLE_PROFILER) profiler.vsyncHandler();
 }
 
 void
@@ -982,7 +1088,7 @@ C64::requestAutoSnapshot()
     if (!isRunning()) {
         
         // Take snapshot immediately
-        // autoSnapshot = Snapshot::makeWithC64(this);
+        delete autoSnapshot;
         autoSnapshot = new Snapshot(*this);
         msgQueue.put(MSG_AUTO_SNAPSHOT_TAKEN);
         
@@ -999,7 +1105,7 @@ C64::requestUserSnapshot()
     if (!isRunning()) {
         
         // Take snapshot immediately
-        // userSnapshot = Snapshot::makeWithC64(this);
+        delete userSnapshot;
         userSnapshot = new Snapshot(*this);
         msgQueue.put(MSG_USER_SNAPSHOT_TAKEN);
         
@@ -1040,7 +1146,27 @@ C64::loadSnapshot(const Snapshot &snapshot)
     suspended {
         
         // Restore the saved state
-        load(snapshot.getData());
+        missingRoms = 0;
+        if (snapshot.isDelta()) {
+            
+            try {
+                loadDelta(snapshot.getData(), snapshot.getDataEnd());
+            } catch (VC64Error &) {
+                
+                // Don't keep running with a partially restored state
+                hardReset();
+                throw;
+            }
+            
+        } else {
+            load(snapshot.getData());
+        }
+        
+        // Store all memory pages in the next delta snapshot
+        markDirty();
+        
+        // Forget about the past of the replaced state
+        rewindBuffer.clear();
         
         // Clear the keyboard matrix to avoid constantly pressed keys
         keyboard.releaseAll();
@@ -1049,6 +1175,45 @@ C64::loadSnapshot(const Snapshot &snapshot)
         if constexpr (SNP_DEBUG) dump();
     }
     
+    // Check if all Roms the snapshot refers to have been available
+    if (missingRoms) throw VC64Error(ERROR_SNP_ROM_MISSING);
+    
+    // Inform the GUI
+    msgQueue.put(MSG_SNAPSHOT_RESTORED);
+}
+
+void
+C64::commitDeltaSnapshot(const Snapshot &snapshot)
+{
+    assert(snapshot.isDelta());
+    
+    // Start over with tracking memory modifications
+    suspended { markClean(); }
+}
+
+void
+C64::rewindTo(Cycle cycle)
+{
+    suspended {
+        
+        // Only the past can be restored
+        if (cycle > (Cycle)cpu.cycle) throw VC64Error(ERROR_SNP_NOT_RECORDED);
+        
+        // Find the latest state recorded before the target cycle
+        auto entry = rewindBuffer.find(cycle);
+        if (!entry) throw VC64Error(ERROR_SNP_NOT_RECORDED);
+        
+        // Restore the recorded state
+        rewindBuffer.restore(*entry);
+        markDirty();
+        
+        // Emulate the C64 until the target cycle has been reached
+        while ((Cycle)cpu.cycle < cycle) executeOneCycle();
+        
+        // Ignore all breakpoints that have been hit on the way
+        clearFlag(RL::BREAKPOINT | RL::WATCHPOINT);
+    }
+    
     // Inform the GUI
     msgQueue.put(MSG_SNAPSHOT_RESTORED);
 }
@@ -1317,6 +1482,8 @@ C64::loadRom(const RomFile &file)
         default:
             fatalError;
     }
+    
+    mem.romDidChange();
 }
 
 void
@@ -1348,6 +1515,8 @@ C64::deleteRom(RomType type)
         default:
             fatalError;
     }
+    
+    mem.romDidChange();
 }
 
 void
@@ -1422,6 +1591,8 @@ C64::flash(const AnyFile &file)
             default:
                 fatalError;
         }
+        
+        mem.romDidChange();
     }
 }
 
@@ -1444,6 +1615,7 @@ C64::flash(const AnyCollection &file, isize nr)
                 
                 size = std::min(size - 2, (u64)(0x10000 - addr));
                 file.copyItem(nr, mem.ram + addr, size, 2);
+                mem.ramDirty.markRange(addr, size);
                 break;
                 
             default:
@@ -1468,6 +1640,7 @@ C64::flash(const FSDevice &fs, isize nr)
         
         size = std::min(size - 2, (u64)(0x10000 - addr));
         fs.copyFile(nr, mem.ram + addr, size, 2);
+        mem.ramDirty.markRange(addr, size);
     }
     
     msgQueue.put(MSG_FILE_FLASHED);
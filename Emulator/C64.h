@@ -30,6 +30,8 @@
 #include "Recorder.h"
 #include "RegressionTester.h"
 #include "RetroShell.h"
+#include "RewindBuffer.h"
+#include "Profiler.h"
 
 // Cartridges
 #include "Cartridge.h"
@@ -100,6 +102,8 @@ public:
     RetroShell retroShell = RetroShell(*this);
     RegressionTester regressionTester = RegressionTester(*this);
     Recorder recorder = Recorder(*this);
+    RewindBuffer rewindBuffer = RewindBuffer(*this);
+    Profiler profiler = Profiler(*this);
     MsgQueue msgQueue = MsgQueue(*this);
 
     
@@ -117,6 +121,9 @@ private:
      */
     RunLoopFlags flags = 0;
 
+    // Indicates if the emulator is running in fast-forward mode
+    bool fastForwardMode = false;
+
     
     //
     // Snapshot storage
@@ -127,6 +134,13 @@ private:
     Snapshot *autoSnapshot = nullptr;
     Snapshot *userSnapshot = nullptr;
 
+public:
+    
+    /* Number of Roms that could not be fetched from the Rom store while
+     * loading the most recent snapshot.
+     */
+    isize missingRoms = 0;
+
     
     //
     // State
@@ -172,7 +186,7 @@ private:
     
 public:
     
-    C64();
+    C64(bool threaded = true);
     ~C64();
     
     const char *getDescription() const override { return "C64"; }
@@ -293,6 +307,11 @@ private:
     // Main execution method (from Thread class)
     void execute() override;
 
+    /* Processes all pending run loop flags. The function returns true if one
+     * of the flags requests the run loop to terminate.
+     */
+    bool processFlags();
+
 public:
 
     bool getUltimax() const { return ultimax; }
@@ -338,6 +357,34 @@ public:
      */
     void executeOneFrame();
     
+    /* Emulates the C64 for a certain number of frames inside the calling
+     * thread. Similar to stepInto(), this function must not be called while
+     * the emulator thread is running. It is utilized by the headless runner
+     * which drives the emulator without the help of the emulator thread. Run
+     * loop flags are processed after each frame. If one of them requests the
+     * run loop to terminate (e.g., because the CPU jammed), the function
+     * returns early. The return value is the number of completed frames.
+     */
+    isize executeFrames(isize count);
+    
+    /* Emulates the C64 as fast as possible until the specified cycle has been
+     * reached. During the entire span, the emulator runs in fast-forward mode
+     * which skips all work that is not visible to the emulated machine:
+     * Scanlines are only drawn if they contain sprites (which keeps the
+     * collision registers exact), reSID is clocked without producing sound
+     * samples, and the DMA debugger and the screen recorder are put aside.
+     * reSID's oscillators and envelope generators are kept cycle-exact, but
+     * its filters stay frozen for the whole span. Hence, the audio output
+     * and the filter state in snapshots differ from a cycle-exact run until
+     * the filters have settled again after fast-forward mode has been left.
+     * Like executeFrames(), the function must not be called while the
+     * emulator thread is running and returns early if a run loop flag
+     * requests the run loop to terminate. The return value is the number of
+     * emulated cycles.
+     */
+    Cycle fastForward(Cycle cycle);
+    bool inFastForwardMode() const { return fastForwardMode; }
+    
     /* Emulates the C64 until the end of the current scanline. This function
      * is called inside executeOneFrame().
      */
@@ -386,9 +433,28 @@ public:
     Snapshot *latestAutoSnapshot();
     Snapshot *latestUserSnapshot();
     
-    // Loads the current state from a snapshot file
+    /* Loads the current state from a snapshot file. Delta snapshots must be
+     * restored in the order they were taken (see class Snapshot).
+     */
     void loadSnapshot(const Snapshot &snapshot) throws;
     
+    /* Makes a delta snapshot the new base of the chain. Afterwards, the next
+     * delta snapshot only contains the memory pages modified from now on.
+     * Call this function once the snapshot has been accepted and before the
+     * emulator continues to run. If the snapshot is dropped instead (or can't
+     * be written), don't call it. The next delta snapshot then includes all
+     * pages of the dropped one and the chain stays intact.
+     */
+    void commitDeltaSnapshot(const Snapshot &snapshot);
+    
+    /* Reverts the emulator to a previous point in time. The latest state that
+     * has been recorded by the rewind buffer before the specified cycle is
+     * restored. Afterwards, the C64 is emulated until the specified cycle is
+     * reached. The function throws an exception if the rewind buffer does not
+     * cover the requested cycle.
+     */
+    void rewindTo(Cycle cycle) throws;
+    
     
     //
     // Handling Roms
@@ -372,6 +372,18 @@ public:
     // Returns true if the next cycle marks the beginning of an instruction
     bool inFetchPhase() const { return next == fetch; }
 
+    // Returns true if an interrupt is about to be processed
+    bool interruptPending() const { return doNmi || doIrq; }
+
+    /* Shifts all interrupt line changes that happened after the specified
+     * cycle. This function is utilized by the drives to fast-forward the CPU
+     * over skipped iterations of an idle loop.
+     */
+    void shiftInterruptLines(u64 since, i64 cycles) {
+        if (edgeDetector.lastWrite() > (i64)since) edgeDetector.shift(cycles);
+        if (levelDetector.lastWrite() > (i64)since) levelDetector.shift(cycles);
+    }
+
     // Executes the next micro instruction
     void executeOneCycle();
 
@@ -178,6 +178,7 @@ void
 Watchpoints::setNeedsCheck(bool value)
 {
     cpu.mem.checkWatchpoints = value;
+    cpu.mem.updatePageTables();
 }
 
 //
@@ -3190,6 +3190,11 @@ template <> void CPU<C64Memory>::done() {
         // Check if a breakpoint has been reached
         if (debugger.breakpointMatches(reg.pc)) c64.signalBreakpoint();
     }
+
+    // Check if the Kernal's LOAD routine is about to be entered
+    if (unlikely(reg.pc == 0xF4A5)) {
+        if (!drive8.serveLoad()) drive9.serveLoad();
+    }
     
     reg.pc0 = reg.pc;
     next = fetch;
@@ -87,7 +87,7 @@ ProcessorPort::write(u8 value)
     }
     
     // When writing to the port register, the last VICII byte appears in 0x0001
-    mem.ram[0x0001] = vic.getDataBusPhi1();
+    mem.pokeRam(0x0001, vic.getDataBusPhi1());
     
     // Switch memory banks
     mem.updatePeekPokeLookupTables();
@@ -117,7 +117,7 @@ ProcessorPort::writeDirection(u8 value)
     direction = value;
     
     // When writing to the direction register, the last VICII byte appears
-    mem.ram[0x0000] = vic.getDataBusPhi1();
+    mem.pokeRam(0x0000, vic.getDataBusPhi1());
     
     // Switch memory banks
     mem.updatePeekPokeLookupTables();
@@ -195,7 +195,7 @@ Cartridge::_reset(bool hard)
     RESET_SNAPSHOT_ITEMS(hard)
     
     // Reset external RAM
-    if (externalRam && !battery) memset(externalRam, 0xFF, ramCapacity);
+    if (externalRam && !battery) eraseRAM(0xFF);
  
     // Reset all chip packets
     for (isize i = 0; i < numPackets; i++) packet[i]->_reset(hard);
@@ -268,6 +268,7 @@ Cartridge::_load(const u8 *buffer)
         externalRam = new u8[ramCapacity];
         for (isize i = 0; i < ramCapacity; i++) externalRam[i] = util::read8(reader.ptr);
     }
+    ramDirty.resize(ramCapacity);
 
     trace(SNP_DEBUG, "Recreated from %ld bytes\n", reader.ptr - buffer);
     return reader.ptr - buffer;
@@ -298,6 +299,106 @@ Cartridge::_save(u8 *buffer)
     return writer.ptr - buffer;
 }
 
+isize
+Cartridge::_deltaSize()
+{
+    util::SerCounter counter;
+    applyToPersistentItems(counter);
+    applyToResetItems(counter);
+ 
+    // Determine size of all packets
+    isize packetSize = 0;
+    for (isize i = 0; i < numPackets; i++) {
+        assert(packet[i] != nullptr);
+        packetSize += packet[i]->_size();
+    }
+    
+    return ramDirty.deltaSize() + packetSize + counter.count;
+}
+
+isize
+Cartridge::_loadDelta(const u8 *buffer, const u8 *end)
+{
+    util::SerCounter counter;
+    applyToPersistentItems(counter);
+    applyToResetItems(counter);
+    if (counter.count > end - buffer) throw VC64Error(ERROR_SNP_CORRUPTED);
+
+    // Keep the on-board RAM which is only partially stored in delta snapshots
+    u8 *ram = externalRam;
+    i64 capacity = ramCapacity;
+    externalRam = nullptr;
+    dealloc();
+
+    util::SerReader reader(buffer);
+    applyToPersistentItems(reader);
+    applyToResetItems(reader);
+    
+    // Reject packet counts and RAM sizes a cartridge can't have
+    if (numPackets < 0 || numPackets > MAX_PACKETS || ramCapacity < 0) {
+        
+        delete [] ram;
+        numPackets = 0;
+        ramCapacity = 0;
+        ramDirty.resize(0);
+        throw VC64Error(ERROR_SNP_CORRUPTED);
+    }
+    
+    // Load ROM packets
+    for (isize i = 0; i < numPackets; i++) {
+        
+        assert(packet[i] == nullptr);
+        packet[i] = new CartridgeRom(c64);
+        
+        if (packet[i]->_size() > end - reader.ptr) {
+            
+            numPackets = i + 1;
+            externalRam = ram;
+            ramCapacity = capacity;
+            throw VC64Error(ERROR_SNP_CORRUPTED);
+        }
+        reader.ptr += packet[i]->_load(reader.ptr);
+    }
+
+    // Reallocate on-board RAM if the capacity has changed
+    if (ramCapacity != capacity) {
+        
+        delete [] ram;
+        ram = ramCapacity ? new u8[ramCapacity] : nullptr;
+        if (ram) memset(ram, 0xFF, ramCapacity);
+        ramDirty.resize(ramCapacity);
+    }
+    externalRam = ram;
+    
+    // Load all modified RAM pages
+    isize count = ramDirty.loadDelta(externalRam, reader.ptr, end);
+    if (count < 0) throw VC64Error(ERROR_SNP_CORRUPTED);
+    reader.ptr += count;
+    
+    trace(SNP_DEBUG, "Recreated from %ld delta bytes\n", reader.ptr - buffer);
+    return reader.ptr - buffer;
+}
+
+isize
+Cartridge::_saveDelta(u8 *buffer)
+{
+    util::SerWriter writer(buffer);
+    applyToPersistentItems(writer);
+    applyToResetItems(writer);
+    
+    // Save ROM packets
+    for (isize i = 0; i < numPackets; i++) {
+        assert(packet[i] != nullptr);
+        writer.ptr += packet[i]->_save(writer.ptr);
+    }
+    
+    // Save all modified RAM pages
+    writer.ptr += ramDirty.saveDelta(externalRam, writer.ptr);
+    
+    trace(SNP_DEBUG, "Serialized %ld delta bytes\n", writer.ptr - buffer);
+    return writer.ptr - buffer;
+}
+
 u8
 Cartridge::peek(u16 addr)
 {
@@ -379,7 +480,7 @@ Cartridge::poke(u16 addr, u8 value)
     }
         
     // Write to RAM if we don't run in Ultimax mode
-    if (!c64.getUltimax()) mem.ram[addr] = value;
+    if (!c64.getUltimax()) mem.pokeRam(addr, value);
 }
 
 isize
@@ -409,6 +510,8 @@ Cartridge::setRamCapacity(isize size)
         ramCapacity = (u64)size;
         memset(externalRam, 0xFF, size);
     }
+    
+    ramDirty.resize(ramCapacity);
 }
 
 u8
@@ -423,6 +526,7 @@ Cartridge::pokeRAM(u16 addr, u8 value)
 {
     assert(addr < ramCapacity);
     externalRam[addr] = value;
+    ramDirty.mark(addr);
 }
 
 void
@@ -430,6 +534,7 @@ Cartridge::eraseRAM(u8 value)
 {
     assert(externalRam != nullptr);
     memset(externalRam, value, ramCapacity);
+    ramDirty.markAll();
 }
 
 void
@@ -13,6 +13,7 @@
 #include "SubComponent.h"
 #include "CartridgeRom.h"
 #include "CRTFile.h"
+#include "DirtyPages.h"
 
 class Cartridge : public SubComponent {
     
@@ -79,6 +80,9 @@ private:
     // RAM capacity in bytes
     i64 ramCapacity = 0;
     
+    // Pages of RAM that have been modified since the last delta snapshot
+    util::DirtyPages ramDirty;
+    
     // Indicates whether RAM data is preserved during a reset
     bool battery = false;
 
@@ -200,6 +204,11 @@ protected:
     isize _size() override;
     isize _load(const u8 *buffer) override;
     isize _save(u8 *buffer) override;
+    isize _deltaSize() override;
+    isize _loadDelta(const u8 *buffer, const u8 *end) override;
+    isize _saveDelta(u8 *buffer) override;
+    void _markDirty() override { ramDirty.markAll(); }
+    void _markClean() override { ramDirty.clear(); }
         
     
     //
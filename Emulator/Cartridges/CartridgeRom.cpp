@@ -9,6 +9,8 @@
 
 #include "config.h"
 #include "CartridgeRom.h"
+#include "C64.h"
+#include "RomStore.h"
 
 CartridgeRom::CartridgeRom(C64 &ref) : SubComponent(ref)
 {
@@ -21,6 +23,7 @@ CartridgeRom::CartridgeRom(C64 &ref, u16 size, u16 loadAddress, const u8 *buffer
     rom = new u8[size];
     if (buffer) {
         memcpy(rom, buffer, size);
+        romKey = util::RomStore::shared().add(rom, size);
     }
 }
 
@@ -43,7 +46,7 @@ CartridgeRom::_size()
     applyToPersistentItems(counter);
     applyToResetItems(counter);
     
-    return size + counter.count;
+    return counter.count;
 }
 
 isize
@@ -57,8 +60,13 @@ CartridgeRom::_load(const u8 *buffer)
     if (rom) delete[] rom;
     rom = new u8[size];
     
-    // Read packet data
-    for (int i = 0; i < size; i++) rom[i] = util::read8(reader.ptr);
+    // Fetch packet data from the Rom store
+    if (!util::RomStore::shared().restore(romKey, rom, size)) {
+        
+        warn("Rom %llx is not available in the Rom store\n", romKey);
+        memset(rom, 0, size);
+        c64.missingRoms++;
+    }
 
     trace(SNP_DEBUG, "Recreated from %ld bytes\n", reader.ptr - buffer);
     return reader.ptr - buffer;
@@ -67,13 +75,13 @@ CartridgeRom::_load(const u8 *buffer)
 isize
 CartridgeRom::_save(u8 *buffer)
 {
+    // Packet data is kept in the Rom store
+    if (romKey == 0) romKey = util::RomStore::shared().add(rom, size);
+    
     util::SerWriter writer(buffer);
     applyToPersistentItems(writer);
     applyToResetItems(writer);
 
-    // Write packet data
-    for (int i = 0; i < size; i++) util::write8(writer.ptr, rom[i]);
-
     trace(SNP_DEBUG, "Serialized to %ld bytes\n", writer.ptr - buffer);
     return writer.ptr - buffer;
 }
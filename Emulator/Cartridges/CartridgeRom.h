@@ -32,6 +32,11 @@ public:
      */
     u16 loadAddress = 0;
     
+    /* Key of the Rom data in the Rom store. Snapshots only record this key
+     * instead of the Rom data.
+     */
+    u64 romKey = 0;
+    
     
     //
     // Initializing
@@ -61,7 +66,8 @@ private:
         worker
         
         << size
-        << loadAddress;
+        << loadAddress
+        << romKey;
     }
     
     template <class T>
@@ -112,7 +112,7 @@ PageFox::pokeRomL(u16 addr, u8 value)
     } else {
         debug(CRT_DEBUG, "pokeRomL(%x, %x)\n", addr, value);
     }
-    mem.ram[0x8000 + addr] = value;
+    mem.pokeRam(0x8000 + addr, value);
 }
 
 void
@@ -124,7 +124,7 @@ PageFox::pokeRomH(u16 addr, u8 value)
     } else {
         debug(CRT_DEBUG, "pokeRomH(%x, %x)\n", addr, value);
     }
-    mem.ram[0xA000 + addr] = value;
+    mem.pokeRam(0xA000 + addr, value);
 }
 
 u8
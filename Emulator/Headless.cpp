@@ -0,0 +1,521 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "Headless.h"
+#include "Benchmark.h"
+#include "IO.h"
+#include "Parser.h"
+#include "Script.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+int
+main(int argc, char *argv[])
+{
+    return Headless().main(argc, argv);
+}
+
+int
+Headless::main(int argc, char *argv[])
+{
+    int result;
+
+    try {
+
+        parseArguments(argc, argv);
+
+        // Run the benchmark suite if requested
+        if (benchmark) return Benchmark(roms, model, frames).run();
+
+        // Create all instances without a thread
+        for (isize i = 0; i < numInstances; i++) {
+
+            instances.push_back(std::make_unique<C64>(false));
+            configure(*instances.back());
+        }
+        result = numInstances == 1 ? run(*instances[0]) : runPooled();
+
+    } catch (util::ParseError &err) {
+
+        std::cerr << "Invalid argument: " << err.what() << std::endl;
+        if (!err.expected.empty()) std::cerr << "Expected: " << err.expected << std::endl;
+        usage(argv[0]);
+        result = headless::ERROR;
+
+    } catch (std::exception &err) {
+
+        std::cerr << "Error: " << err.what() << std::endl;
+        result = headless::ERROR;
+    }
+
+    // Shut down all instances
+    for (auto &c64 : instances) c64->halt();
+
+    return result;
+}
+
+void
+Headless::parseArguments(int argc, char *argv[])
+{
+    auto value = [&](int &i) {
+        if (i + 1 >= argc) throw util::ParseError(argv[i], "an argument");
+        return string(argv[++i]);
+    };
+
+    for (int i = 1; i < argc; i++) {
+
+        string arg = argv[i];
+
+        if (arg == "-r" || arg == "--rom") {
+            roms.push_back(value(i));
+
+        } else if (arg == "-m" || arg == "--model") {
+            model = (C64Model)util::parseEnum <C64ModelEnum> (value(i));
+
+        } else if (arg == "-f" || arg == "--frames") {
+            auto token = value(i);
+            frames = util::parseNum(token);
+
+        } else if (arg == "-b" || arg == "--boot") {
+            auto token = value(i);
+            bootFrames = util::parseNum(token);
+
+        } else if (arg == "-s" || arg == "--script") {
+            script = value(i);
+
+        } else if (arg == "-t" || arg == "--type") {
+            text = value(i);
+
+        } else if (arg == "-q" || arg == "--quiet") {
+            quiet = true;
+
+        } else if (arg == "-i" || arg == "--instances") {
+            auto token = value(i);
+            numInstances = util::parseNum(token);
+            if (numInstances < 1) throw util::ParseError(token, "a positive number");
+
+        } else if (arg == "-w" || arg == "--workers") {
+            auto token = value(i);
+            numWorkers = util::parseNum(token);
+
+        } else if (arg == "-B" || arg == "--benchmark") {
+            benchmark = true;
+
+        } else if (arg == "-a" || arg == "--audio") {
+            audio = value(i);
+
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            exit(headless::OK);
+
+        } else if (arg[0] == '-' || !media.empty()) {
+            throw util::ParseError(arg);
+
+        } else {
+            media = arg;
+        }
+    }
+
+    // Emulate 60 seconds if neither a frame count nor a script is given
+    if (frames < 0 && script.empty()) frames = benchmark ? 1000 : 3000;
+
+    // Benchmarks run with built-in workloads only
+    if (benchmark && !media.empty()) throw util::ParseError(media);
+    if (benchmark && !script.empty()) throw util::ParseError("--script");
+    if (benchmark && !audio.empty()) throw util::ParseError("--audio");
+
+    // Scripts can only be processed in single instance mode
+    if (numInstances > 1 && frames < 0) throw util::ParseError("--frames");
+    if (numInstances > 1 && !script.empty()) throw util::ParseError("--script");
+
+    // Audio can only be rendered in single instance mode
+    if (numInstances > 1 && !audio.empty()) throw util::ParseError("--audio");
+}
+
+void
+Headless::usage(const char *exec)
+{
+    std::cerr << "Usage: " << exec << " [options] [file]" << std::endl << std::endl;
+    std::cerr << "   -r, --rom <file>      Installs a Rom image (repeatable)" << std::endl;
+    std::cerr << "   -m, --model <model>   Selects the C64 model (" << C64ModelEnum::keyList() << ")" << std::endl;
+    std::cerr << "   -f, --frames <n>      Number of frames to emulate" << std::endl;
+    std::cerr << "   -b, --boot <n>        Number of frames to emulate before the file is run" << std::endl;
+    std::cerr << "   -s, --script <file>   Executes a RetroShell script" << std::endl;
+    std::cerr << "   -t, --type <text>     Types in text after the file has been attached" << std::endl;
+    std::cerr << "   -q, --quiet           Suppresses the timing report" << std::endl;
+    std::cerr << "   -i, --instances <n>   Number of emulator instances to run" << std::endl;
+    std::cerr << "   -w, --workers <n>     Number of worker threads (default: all cores)" << std::endl;
+    std::cerr << "   -B, --benchmark       Runs the benchmark suite" << std::endl;
+    std::cerr << "   -a, --audio <file>    Renders the audio output into a WAV or raw file" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Emulation stops after the given number of frames or when the" << std::endl;
+    std::cerr << "script has been processed. Without both, 3000 frames are emulated." << std::endl;
+    std::cerr << "Scripts and audio rendering are not supported with more than" << std::endl;
+    std::cerr << "one instance. Files without a .wav suffix receive raw 32-bit float" << std::endl;
+    std::cerr << "stereo samples." << std::endl;
+    std::cerr << "In benchmark mode, each workload runs for the given number of" << std::endl;
+    std::cerr << "frames (default: 1000)." << std::endl;
+}
+
+void
+Headless::configure(C64 &c64)
+{
+    // Register as listener to keep track of scripts and CPU jams
+    c64.msgQueue.setListener(this, process);
+
+    // Select the C64 model
+    c64.configure(model);
+
+    // Install Roms
+    for (auto &path : roms) {
+
+        if (!util::fileExists(path)) throw VC64Error(ERROR_FILE_NOT_FOUND, path);
+        c64.loadRom(path);
+    }
+
+    // Cartridges must be plugged in before the machine is switched on
+    if (AnyFile::type(media) == FILETYPE_CRT) {
+
+        CRTFile crt(media);
+        c64.expansionport.attachCartridge(&crt, false);
+    }
+
+    // Skip all timing synchronization code
+    c64.warpOn();
+    c64.setWarpLock(true);
+
+    // Throws an exception if Roms are missing
+    c64.powerOn();
+}
+
+void
+Headless::attachMedia(C64 &c64)
+{
+    if (media.empty()) return;
+
+    if (!util::fileExists(media)) throw VC64Error(ERROR_FILE_NOT_FOUND, media);
+
+    switch (AnyFile::type(media)) {
+
+        case FILETYPE_CRT:
+
+            // Already attached in configure()
+            break;
+
+        case FILETYPE_SNAPSHOT:
+        {
+            Snapshot snapshot(media);
+            c64.loadSnapshot(snapshot);
+            break;
+        }
+        case FILETYPE_SCRIPT:
+        {
+            Script file(media);
+            scriptRunning = true;
+            file.execute(c64);
+            break;
+        }
+        case FILETYPE_PRG:
+        {
+            PRGFile prg(media);
+            flashAndRun(c64, prg);
+            break;
+        }
+        case FILETYPE_P00:
+        {
+            P00File p00(media);
+            flashAndRun(c64, p00);
+            break;
+        }
+        case FILETYPE_T64:
+        {
+            T64File t64(media);
+            flashAndRun(c64, t64);
+            break;
+        }
+        case FILETYPE_D64:
+        {
+            D64File d64(media);
+            if (c64.hasRom(ROM_TYPE_VC1541)) c64.drive8.insertD64(d64, false);
+            flashAndRun(c64, FSDevice(d64));
+            break;
+        }
+        case FILETYPE_G64:
+        {
+            G64File g64(media);
+            if (!c64.hasRom(ROM_TYPE_VC1541)) throw VC64Error(ERROR_ROM_DRIVE_MISSING);
+            c64.drive8.insertG64(g64, false);
+            break;
+        }
+        case FILETYPE_TAP:
+        {
+            TAPFile tap(media);
+            c64.datasette.insertTape(tap);
+            break;
+        }
+        default:
+
+            throw VC64Error(ERROR_FILE_TYPE_MISMATCH, media);
+    }
+
+    if (!text.empty()) c64.keyboard.autoType(text);
+}
+
+void
+Headless::startAudio(C64 &c64)
+{
+    if (audio.empty()) return;
+
+    if (util::lowercased(util::extractSuffix(audio)) == "wav") {
+        audioSink = std::make_unique<WAVAudioSink>(audio, c64.muxer.getSampleRate());
+    } else {
+        audioSink = std::make_unique<RawAudioSink>(audio);
+    }
+    c64.muxer.setSink(audioSink.get());
+}
+
+void
+Headless::stopAudio(C64 &c64)
+{
+    if (!audioSink) return;
+
+    c64.muxer.setSink(nullptr);
+    bool failed = audioSink->hasFailed();
+    audioSink = nullptr;
+
+    // Report write errors which couldn't be thrown during emulation
+    if (failed) throw VC64Error(ERROR_FILE_CANT_WRITE, audio);
+}
+
+void
+Headless::flashAndRun(C64 &c64, const AnyCollection &collection)
+{
+    if (collection.collectionCount() == 0) throw VC64Error(ERROR_FS_HAS_NO_FILES);
+
+    c64.flash(collection, 0);
+    c64.keyboard.autoType("run\n");
+}
+
+void
+Headless::flashAndRun(C64 &c64, const FSDevice &fs)
+{
+    if (fs.numFiles() == 0) throw VC64Error(ERROR_FS_HAS_NO_FILES);
+
+    c64.flash(fs, 0);
+    c64.keyboard.autoType("run\n");
+}
+
+int
+Headless::run(C64 &c64)
+{
+    util::Clock clock;
+
+    u64 firstFrame = c64.frame;
+    Cycle firstCycle = c64.cpu.cycle;
+    u64 lastFrame = frames < 0 ? UINT64_MAX : firstFrame + frames;
+
+    // Let the Kernal initialize the machine
+    fastForward(c64, std::min(bootFrames, frames < 0 ? bootFrames : frames));
+
+    // Attach the media file and launch the script
+    attachMedia(c64);
+    startAudio(c64);
+    if (!script.empty()) {
+
+        if (!util::fileExists(script)) throw VC64Error(ERROR_FILE_NOT_FOUND, script);
+
+        std::ifstream stream(script);
+        scriptRunning = true;
+        c64.retroShell.execScript(stream);
+    }
+    serviceScript(c64);
+
+    // Emulate frame by frame to react to script events in time
+    bool interrupted = false;
+    while (c64.frame < lastFrame && !cpuJammed && !scriptAborted) {
+
+        if (frames < 0 && !scriptRunning) break;
+
+        // Skip all rendering work if no script needs to be serviced
+        if (!scriptRunning) {
+
+            if (!fastForward(c64, (isize)(lastFrame - c64.frame))) interrupted = true;
+            break;
+        }
+
+        if (c64.executeFrames(1) == 0) { interrupted = true; break; }
+        serviceScript(c64);
+    }
+
+    stopAudio(c64);
+    auto elapsed = clock.stop();
+
+    if (!quiet) {
+        report((isize)(c64.frame - firstFrame), c64.cpu.cycle - firstCycle,
+               c64.vic.getFps(), elapsed);
+    }
+
+    if (cpuJammed) return headless::CPU_JAMMED;
+    if (scriptAborted) return headless::SCRIPT_ABORT;
+    if (interrupted) return headless::BREAKPOINT;
+    return headless::OK;
+}
+
+int
+Headless::runPooled()
+{
+    util::Clock clock;
+
+    Scheduler scheduler(numWorkers);
+
+    std::vector<u64> firstFrame;
+    std::vector<Cycle> firstCycle;
+    for (auto &c64 : instances) {
+
+        firstFrame.push_back(c64->frame);
+        firstCycle.push_back(c64->cpu.cycle);
+    }
+
+    // Let the Kernal initialize all machines
+    auto boot = std::min(bootFrames, frames);
+    for (auto &c64 : instances) {
+
+        c64->run();
+        scheduler.add(*c64, boot);
+    }
+    scheduler.waitForCompletion();
+
+    // Attach the media file and emulate the remaining frames
+    for (auto &c64 : instances) {
+
+        attachMedia(*c64);
+        scheduler.setBudget(*c64, frames - boot);
+    }
+    scheduler.waitForCompletion();
+
+    auto elapsed = clock.stop();
+
+    if (!quiet) {
+
+        isize numFrames = 0;
+        Cycle numCycles = 0;
+        for (usize i = 0; i < instances.size(); i++) {
+
+            numFrames += (isize)(instances[i]->frame - firstFrame[i]);
+            numCycles += instances[i]->cpu.cycle - firstCycle[i];
+        }
+
+        report(numFrames, numCycles, instances[0]->vic.getFps(), elapsed);
+        std::cout << std::endl;
+        scheduler.dump(dump::State);
+        scheduler.dump(dump::Events);
+    }
+
+    // Take all instances out of the pool
+    for (auto &c64 : instances) {
+
+        c64->pause();
+        scheduler.remove(*c64);
+    }
+
+    return cpuJammed ? headless::CPU_JAMMED : headless::OK;
+}
+
+bool
+Headless::fastForward(C64 &c64, isize numFrames)
+{
+    if (numFrames <= 0) return true;
+    
+    auto &vic = c64.vic;
+    
+    // Compute the first cycle of the target frame
+    Cycle target = (Cycle)c64.cpu.cycle;
+    target += (vic.getLinesPerFrame() - c64.scanline) * vic.getCyclesPerLine();
+    target -= c64.rasterCycle - 1;
+    target += (numFrames - 1) * vic.getCyclesPerFrame();
+    
+    c64.fastForward(target);
+    
+    return (Cycle)c64.cpu.cycle == target;
+}
+
+void
+Headless::serviceScript(C64 &c64)
+{
+    if (scriptWakeUp) {
+
+        scriptWakeUp = false;
+        c64.retroShell.continueScript();
+    }
+
+    // Scripts must not hand over control to the emulator thread
+    if (c64.isRunning()) c64.pause();
+}
+
+void
+Headless::report(isize numFrames, Cycle numCycles, double fps, util::Time elapsed)
+{
+    using namespace util;
+
+    auto seconds = elapsed.asSeconds();
+    auto emulated = numFrames / fps;
+    auto &os = std::cout;
+
+    os << tab("Emulated frames") << numFrames << std::endl;
+    os << tab("Emulated cycles") << numCycles << std::endl;
+    os << tab("Emulated time") << emulated << " sec" << std::endl;
+    os << tab("Host time") << seconds << " sec" << std::endl;
+
+    if (seconds > 0) {
+
+        os << tab("Frames per second") << numFrames / seconds << std::endl;
+        os << tab("Cycles per second") << numCycles / seconds << std::endl;
+        os << tab("Speed") << emulated / seconds << "x" << std::endl;
+    }
+}
+
+void
+Headless::process(const void *listener, long type, long data)
+{
+    ((Headless *)listener)->process(type, data);
+}
+
+void
+Headless::process(long type, long data)
+{
+    switch (type) {
+
+        case MSG_SCRIPT_DONE:
+
+            scriptRunning = false;
+            break;
+
+        case MSG_SCRIPT_ABORT:
+
+            scriptRunning = false;
+            scriptAborted = true;
+            break;
+
+        case MSG_SCRIPT_WAKEUP:
+
+            scriptWakeUp = true;
+            break;
+
+        case MSG_CPU_JAMMED:
+
+            cpuJammed++;
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,179 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "C64.h"
+#include "Scheduler.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/* The headless runner is the entry point of the command line version of the
+ * emulator which is created by the 'bin' target of the Makefile. It creates a
+ * C64, installs the provided Rom images, attaches a media file, and emulates
+ * the machine as fast as possible. Emulation ends after a given number of
+ * frames or when a RetroShell script has been processed.
+ *
+ * Other than the GUI, the runner does not launch the emulator thread. It
+ * drives the emulator directly by calling C64::executeFrames() which means
+ * that the emulator is in paused state the whole time. This keeps timing
+ * synchronization out of the way and makes each run fully deterministic.
+ * As long as no script is processed, the runner calls C64::fastForward()
+ * instead which skips all rendering and audio work nobody looks at.
+ *
+ * If more than one instance is requested, the runner operates in pooled mode.
+ * All instances are created without a thread and handed over to a Scheduler
+ * which executes them on a shared pool of worker threads. Each instance is
+ * emulated for the given number of frames. Afterwards, the aggregated
+ * throughput and the per-instance statistics of the scheduler are reported.
+ *
+ * With option --audio, the SID output is rendered offline into a WAV file or
+ * into a raw file of interleaved 32-bit floats (see Muxer::setSink()). Audio
+ * is recorded from the moment the media file has been attached. Since the
+ * SIDs are synthesized in fast-forward mode, too, the audio is rendered as
+ * fast as possible while VICII only draws what is needed for emulation.
+ *
+ * With option --benchmark, the runner hands control over to the benchmark
+ * suite which runs a set of built-in workloads (see Benchmark.h).
+ *
+ * When the emulator terminates, a timing report is written to stdout and one
+ * of the exit codes defined below is handed back to the calling process.
+ */
+
+namespace headless {
+
+constexpr int OK            = 0; // Emulation has finished regularly
+constexpr int ERROR         = 1; // Invalid arguments or media files
+constexpr int CPU_JAMMED    = 2; // The CPU has executed an illegal instruction
+constexpr int SCRIPT_ABORT  = 3; // The RetroShell script has been aborted
+constexpr int BREAKPOINT    = 4; // The run loop has been interrupted
+
+}
+
+class Headless {
+
+    // The emulator instances (a single one unless running in pooled mode)
+    std::vector<std::unique_ptr<C64>> instances;
+
+
+    //
+    // Command line arguments
+    //
+
+    // Rom images to install
+    std::vector<string> roms;
+
+    // The media file to attach (PRG, P00, T64, D64, G64, TAP, CRT, VC64, INI)
+    string media;
+
+    // A RetroShell script to execute
+    string script;
+
+    // The emulated C64 model
+    C64Model model = C64_MODEL_PAL;
+
+    // Number of frames to emulate (-1 = until the script terminates)
+    isize frames = -1;
+
+    // Number of frames to emulate before the media file is flashed
+    isize bootFrames = 150;
+
+    // Text to type in after the media file has been attached
+    string text;
+
+    // Indicates if the timing report should be suppressed
+    bool quiet = false;
+
+    // Number of emulator instances to run in parallel
+    isize numInstances = 1;
+
+    // Number of worker threads in pooled mode (0 = number of cores)
+    isize numWorkers = 0;
+
+    // Indicates if the benchmark suite should be run
+    bool benchmark = false;
+
+    // File the audio output is rendered into (WAV or raw)
+    string audio;
+
+
+    //
+    // Run state
+    //
+
+    // Set by the message queue callback
+    bool scriptRunning = false;
+    bool scriptWakeUp = false;
+    bool scriptAborted = false;
+    
+    // Number of instances that have jammed the CPU (pooled mode: any thread)
+    std::atomic<isize> cpuJammed = 0;
+
+    // Receiver of the audio output (if rendering offline)
+    std::unique_ptr<AudioSink> audioSink;
+
+
+    //
+    // Running
+    //
+
+public:
+
+    // Main entry point
+    int main(int argc, char *argv[]);
+
+private:
+
+    // Parses the command line
+    void parseArguments(int argc, char *argv[]) throws;
+
+    // Prints a usage string
+    void usage(const char *exec);
+
+    // Installs all Roms and configures an emulator instance
+    void configure(C64 &c64) throws;
+
+    // Attaches the media file
+    void attachMedia(C64 &c64) throws;
+
+    // Starts or stops rendering the audio output into a file
+    void startAudio(C64 &c64) throws;
+    void stopAudio(C64 &c64);
+
+    // Flashes the first file of a collection into memory and runs it
+    void flashAndRun(C64 &c64, const AnyCollection &collection) throws;
+    void flashAndRun(C64 &c64, const FSDevice &fs) throws;
+
+    // Runs a single emulator instance
+    int run(C64 &c64) throws;
+
+    // Runs all emulator instances on the worker pool
+    int runPooled() throws;
+
+    /* Emulates a certain number of frames in fast-forward mode. The function
+     * returns false if emulation has been interrupted.
+     */
+    bool fastForward(C64 &c64, isize numFrames);
+
+    // Continues the script if RetroShell has been woken up
+    void serviceScript(C64 &c64);
+
+    // Prints the timing report
+    void report(isize numFrames, Cycle numCycles, double fps, util::Time elapsed);
+
+
+    //
+    // Processing messages
+    //
+
+    static void process(const void *listener, long type, long data);
+    void process(long type, long data);
+};
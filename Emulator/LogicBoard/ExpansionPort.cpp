@@ -68,6 +68,83 @@ ExpansionPort::_save(u8 *buffer)
     return writer.ptr - buffer;
 }
 
+isize
+ExpansionPort::_deltaSize()
+{
+    util::SerCounter counter;
+    applyToPersistentItems(counter);
+    applyToResetItems(counter);
+    
+    if (cartridge) counter.count += cartridge->deltaSize();
+    return counter.count;
+}
+
+isize
+ExpansionPort::_loadDelta(const u8 *buffer, const u8 *end)
+{
+    util::SerCounter counter;
+    applyToPersistentItems(counter);
+    applyToResetItems(counter);
+    if (counter.count > end - buffer) throw VC64Error(ERROR_SNP_CORRUPTED);
+
+    util::SerReader reader(buffer);
+    applyToPersistentItems(reader);
+    applyToResetItems(reader);
+    
+    if (crtType == CRT_NONE) {
+        
+        cartridge = nullptr;
+        
+    } else {
+        
+        try {
+            
+            // Keep the cartridge if possible to preserve the unmodified RAM pages
+            if (!cartridge || cartridge->getCartridgeType() != crtType) {
+                cartridge = std::unique_ptr<Cartridge>(Cartridge::makeWithType(c64, crtType));
+            }
+            reader.ptr += cartridge->loadDelta(reader.ptr, end);
+            
+        } catch (VC64Error &) {
+            
+            // Don't leave a half-restored cartridge behind
+            cartridge = nullptr;
+            crtType = CRT_NONE;
+            throw VC64Error(ERROR_SNP_CORRUPTED);
+        }
+    }
+    
+    trace(SNP_DEBUG, "Recreated from %ld delta bytes\n", reader.ptr - buffer);
+    return reader.ptr - buffer;
+}
+
+isize
+ExpansionPort::_saveDelta(u8 *buffer)
+{
+    util::SerWriter writer(buffer);
+    applyToPersistentItems(writer);
+    applyToResetItems(writer);
+    
+    if (crtType != CRT_NONE) {
+        writer.ptr += cartridge->saveDelta(writer.ptr);
+    }
+    
+    trace(SNP_DEBUG, "Serialized to %ld delta bytes\n", writer.ptr - buffer);
+    return writer.ptr - buffer;
+}
+
+void
+ExpansionPort::_markDirty()
+{
+    if (cartridge) cartridge->markDirty();
+}
+
+void
+ExpansionPort::_markClean()
+{
+    if (cartridge) cartridge->markClean();
+}
+
 void
 ExpansionPort::_dump(dump::Category category, std::ostream& os) const
 {
@@ -144,7 +221,7 @@ ExpansionPort::poke(u16 addr, u8 value)
     if (cartridge) {
         cartridge->poke(addr, value);
     } else if (!c64.getUltimax()) {
-        mem.ram[addr] = value;
+        mem.pokeRam(addr, value);
     }
 }
 
@@ -85,6 +85,11 @@ private:
     isize _size() override;
     isize _load(const u8 *buffer) override;
     isize _save(u8 *buffer) override;
+    isize _deltaSize() override;
+    isize _loadDelta(const u8 *buffer, const u8 *end) override;
+    isize _saveDelta(u8 *buffer) override;
+    void _markDirty() override;
+    void _markClean() override;
 
     
     //
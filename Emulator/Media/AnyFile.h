@@ -123,13 +123,13 @@ protected:
     virtual bool isCompatiblePath(const string &path) = 0;
     virtual bool isCompatibleStream(std::istream &stream) = 0;
     
-    void readFromStream(std::istream &stream) throws;
+    virtual void readFromStream(std::istream &stream) throws;
     void readFromFile(const string &path) throws;
     void readFromBuffer(const u8 *buf, isize len) throws;
 
 public:
     
-    void writeToStream(std::ostream &stream) throws;
+    virtual void writeToStream(std::ostream &stream) throws;
     void writeToFile(const string &path) throws;
     void writeToBuffer(u8 *buf) throws;
 
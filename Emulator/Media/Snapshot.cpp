@@ -10,8 +10,73 @@
 #include "config.h"
 #include "Snapshot.h"
 #include "C64.h"
+#include "Compression.h"
 #include "IO.h"
 
+#include <cstddef>
+#include <vector>
+
+// Flags stored in the container header of compressed snapshot files
+static constexpr u8 SNP_FLAG_DELTA = 0x01;
+static constexpr u8 SNP_FLAG_CONTAINER = 0x80;
+
+// Writes a chunk of data as a sequence of compressed blocks
+static void
+writeBlocks(std::ostream &stream, const u8 *data, isize len)
+{
+    std::vector<u8> block(util::lzBound(util::lzBlockSize) + 8);
+    
+    for (isize pos = 0; pos < len; pos += util::lzBlockSize) {
+        
+        isize rawSize = std::min(len - pos, util::lzBlockSize);
+        u8 *ptr = block.data();
+        
+        isize size = util::lzCompress(data + pos, rawSize, ptr + 8);
+        if (size >= rawSize) {
+            
+            // Store incompressible data as it is
+            size = rawSize;
+            std::memcpy(ptr + 8, data + pos, rawSize);
+        }
+        util::write32(ptr, (u32)size);
+        util::write32(ptr, (u32)rawSize);
+        stream.write((const char *)block.data(), size + 8);
+    }
+}
+
+// Reads a chunk of data that has been written by writeBlocks()
+static void
+readBlocks(std::istream &stream, u8 *data, isize len)
+{
+    std::vector<u8> block(util::lzBound(util::lzBlockSize));
+    
+    for (isize pos = 0; pos < len;) {
+        
+        u8 sizes[8];
+        const u8 *ptr = sizes;
+        if (!stream.read((char *)sizes, 8)) throw VC64Error(ERROR_FILE_CANT_READ);
+        
+        isize size = util::read32(ptr);
+        isize rawSize = util::read32(ptr);
+        if (rawSize > len - pos || size > (isize)block.size()) {
+            throw VC64Error(ERROR_FILE_CANT_READ);
+        }
+        
+        if (size == rawSize) {
+            
+            if (!stream.read((char *)data + pos, size)) throw VC64Error(ERROR_FILE_CANT_READ);
+            
+        } else {
+            
+            if (!stream.read((char *)block.data(), size)) throw VC64Error(ERROR_FILE_CANT_READ);
+            if (!util::lzDecompress(block.data(), size, data + pos, rawSize)) {
+                throw VC64Error(ERROR_FILE_CANT_READ);
+            }
+        }
+        pos += rawSize;
+    }
+}
+
 Thumbnail *
 Thumbnail::makeWithC64(const C64 &c64, isize dx, isize dy)
 {
@@ -58,9 +123,9 @@ Snapshot::isCompatible(std::istream &stream)
     return util::matchingStreamHeader(stream, "VC64");
 }
 
-Snapshot::Snapshot(isize capacity)
+Snapshot::Snapshot(isize capacity, bool delta)
 {
-    size = capacity + sizeof(SnapshotHeader);
+    size = capacity + headerSize(delta);
     data = new u8[size];
     
     SnapshotHeader *header = (SnapshotHeader *)data;
@@ -72,14 +137,144 @@ Snapshot::Snapshot(isize capacity)
     header->major = SNP_MAJOR;
     header->minor = SNP_MINOR;
     header->subminor = SNP_SUBMINOR;
+    header->delta = delta;
 }
 
-Snapshot::Snapshot(C64 &c64): Snapshot(c64.size())
+Snapshot::Snapshot(C64 &c64, bool delta) :
+Snapshot(delta ? c64.deltaSize() : c64.size(), delta)
 {
-    takeScreenshot(c64);
-
     if constexpr (SNP_DEBUG) c64.dump();
-    c64.save(getData());
+
+    if (delta) {
+        
+        c64.saveDelta(getData());
+
+    } else {
+        
+        takeScreenshot(c64);
+        c64.save(getData());
+    }
+}
+
+void
+Snapshot::readFromStream(std::istream &stream)
+{
+    u8 buffer[8 + 8];
+    const u8 *ptr = buffer;
+    
+    // Read raw snapshots as they are
+    stream.seekg(0, std::ios::beg);
+    if (!stream.read((char *)buffer, 8) || !(buffer[7] & SNP_FLAG_CONTAINER)) {
+        
+        stream.clear();
+        stream.seekg(0, std::ios::beg);
+        AnyFile::readFromStream(stream);
+        return;
+    }
+    
+    // Read the container header
+    if (!stream.read((char *)buffer + 8, 8)) throw VC64Error(ERROR_FILE_CANT_READ);
+    ptr += 8;
+    bool delta = buffer[7] & SNP_FLAG_DELTA;
+    isize dataSize = (isize)util::read64(ptr);
+    if (dataSize < 0 || dataSize > 0x10000000) throw VC64Error(ERROR_FILE_CANT_READ);
+    
+    // Allocate memory and set up the header
+    assert(data == nullptr);
+    size = headerSize(delta) + dataSize;
+    data = new u8[size]();
+    
+    SnapshotHeader *header = getHeader();
+    std::memcpy(header->magic, buffer, 4);
+    header->major = buffer[4];
+    header->minor = buffer[5];
+    header->subminor = buffer[6];
+    header->delta = delta;
+    
+    // Read the preview image
+    if (!delta) {
+        
+        u8 info[16];
+        const u8 *ptr = info;
+        if (!stream.read((char *)info, 16)) throw VC64Error(ERROR_FILE_CANT_READ);
+        
+        Thumbnail &thumbnail = header->screenshot;
+        thumbnail.width = util::read32(ptr);
+        thumbnail.height = util::read32(ptr);
+        thumbnail.timestamp = (time_t)util::read64(ptr);
+        
+        if (thumbnail.width > TEX_WIDTH || thumbnail.height > TEX_HEIGHT) {
+            throw VC64Error(ERROR_FILE_CANT_READ);
+        }
+        readBlocks(stream, (u8 *)thumbnail.screen, thumbnail.width * thumbnail.height * 4);
+    }
+    
+    // Read the component data
+    readBlocks(stream, getData(), dataSize);
+}
+
+void
+Snapshot::writeToStream(std::ostream &stream)
+{
+    SnapshotHeader *header = getHeader();
+    isize dataSize = size - headerSize();
+    
+    // Write the container header
+    u8 buffer[8 + 8];
+    u8 *ptr = buffer;
+    std::memcpy(ptr, header->magic, 4);
+    ptr += 4;
+    util::write8(ptr, header->major);
+    util::write8(ptr, header->minor);
+    util::write8(ptr, header->subminor);
+    util::write8(ptr, SNP_FLAG_CONTAINER | (isDelta() ? SNP_FLAG_DELTA : 0));
+    util::write64(ptr, (u64)dataSize);
+    stream.write((const char *)buffer, sizeof(buffer));
+    
+    // Write the preview image with halved resolution
+    if (!isDelta()) {
+        
+        const Thumbnail &thumbnail = getThumbnail();
+        
+        // Images read from a container file have already been halved
+        isize scale = thumbnail.width == VISIBLE_PIXELS ? 2 : 1;
+        isize width = thumbnail.width / scale;
+        isize height = thumbnail.height / scale;
+        
+        std::vector<u32> pixels(width * height);
+        for (isize y = 0; y < height; y++) {
+            for (isize x = 0; x < width; x++) {
+                pixels[y * width + x] = thumbnail.screen[scale * (y * thumbnail.width + x)];
+            }
+        }
+        
+        u8 info[16];
+        u8 *ptr = info;
+        util::write32(ptr, (u32)width);
+        util::write32(ptr, (u32)height);
+        util::write64(ptr, (u64)thumbnail.timestamp);
+        stream.write((const char *)info, sizeof(info));
+        
+        writeBlocks(stream, (const u8 *)pixels.data(), width * height * 4);
+    }
+    
+    // Write the component data
+    writeBlocks(stream, getData(), dataSize);
+    
+    if (!stream) throw VC64Error(ERROR_FILE_CANT_WRITE);
+}
+
+isize
+Snapshot::headerSize(bool delta)
+{
+    return delta ? offsetof(SnapshotHeader, screenshot) : sizeof(SnapshotHeader);
+}
+
+const Thumbnail &
+Snapshot::getThumbnail() const
+{
+    assert(!isDelta());
+    return getHeader()->screenshot;
 }
 
 bool
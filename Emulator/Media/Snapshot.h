@@ -42,10 +42,41 @@ struct SnapshotHeader {
     u8 minor;
     u8 subminor;
     
-    // Preview image
+    // Indicates if this is a delta snapshot
+    bool delta;
+    
+    // Preview image (omitted in delta snapshots)
     Thumbnail screenshot;
 };
 
+/* Besides standard snapshots which store the complete emulator state, the
+ * emulator supports delta snapshots. They are created much faster and
+ * consume far less memory, because they only contain the memory pages of RAM
+ * and ROM that have been modified since the previous delta snapshot was taken
+ * (see class DirtyPages). Hence, a delta snapshot can only be restored on top
+ * of the state it has been taken relative to, i.e., after all of its
+ * predecessors have been restored in order. Besides that, delta snapshots do
+ * not contain a preview image.
+ *
+ * Taking a delta snapshot leaves the emulator state untouched. Once the
+ * snapshot has been accepted (e.g., written to a file), the caller has to
+ * invoke C64::commitDeltaSnapshot() to advance the chain. To start a new
+ * sequence of delta snapshots, call C64::markDirty(). The next delta snapshot
+ * will then contain all memory pages.
+ *
+ * In memory, a snapshot is stored as a SnapshotHeader followed by the raw
+ * component data. Snapshot files are written in a compressed container
+ * format instead. It starts with the same magic bytes and version number,
+ * followed by a flag byte (see below) and the size of the component data.
+ * Standard snapshots continue with the size and the creation date of the
+ * preview image which is stored with halved resolution. Next, the preview
+ * image (if any) and the component data are stored as a sequence of blocks.
+ * Each block starts with its compressed and its uncompressed size (4 bytes
+ * each). If both sizes match, the block is stored uncompressed. Otherwise,
+ * it is compressed with the LZ codec from Compression.h. Files without the
+ * container flag are read as raw snapshots.
+ */
+
 class Snapshot : public AnyFile {
 
 public:
@@ -64,8 +95,8 @@ public:
      
     Snapshot(const string &path) throws { init(path); }
     Snapshot(const u8 *buf, isize len) throws { init(buf, len); }
-    Snapshot(isize capacity);
-    Snapshot(class C64 &c64);
+    Snapshot(isize capacity, bool delta = false);
+    Snapshot(class C64 &c64, bool delta = false);
 
     
     //
@@ -82,6 +113,13 @@ public:
     bool isCompatiblePath(const string &path) override { return isCompatible(path); }
     bool isCompatibleStream(std::istream &stream) override { return isCompatible(stream); }
     FileType type() const override { return FILETYPE_SNAPSHOT; }
+    void writeToStream(std::ostream &stream) throws override;
+    
+private:
+    
+    void readFromStream(std::istream &stream) throws override;
+    
+public:
     
     
     //
@@ -96,11 +134,21 @@ public:
     // Returns a pointer to the snapshot header
     SnapshotHeader *getHeader() const { return (SnapshotHeader *)data; }
 
+    // Checks whether this is a delta snapshot
+    bool isDelta() const { return getHeader()->delta; }
+
+    // Returns the size of the snapshot header
+    isize headerSize() const { return headerSize(isDelta()); }
+    static isize headerSize(bool delta);
+
     // Returns a pointer to the thumbnail image
-    const Thumbnail &getThumbnail() const { return getHeader()->screenshot; }
+    const Thumbnail &getThumbnail() const;
 
     // Returns pointer to the core data
-    u8 *getData() const { return data + sizeof(SnapshotHeader); }
+    u8 *getData() const { return data + headerSize(); }
+
+    // Returns a pointer to the first byte behind the core data
+    u8 *getDataEnd() const { return data + size; }
         
     // Records a screenshot
     void takeScreenshot(class C64 &c64);
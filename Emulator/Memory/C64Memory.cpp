@@ -11,6 +11,7 @@
 #include "C64Memory.h"
 #include "C64.h"
 #include "IO.h"
+#include "RomStore.h"
 
 #include <random>
 
@@ -98,6 +99,7 @@ C64Memory::C64Memory(C64 &ref) : SubComponent(ref)
     for (isize i = 0x1; i <= 0xF; i++) {
         peekSrc[i] = pokeTarget[i] = M_RAM;
     }
+    updatePageTables();
 }
 
 void
@@ -118,6 +120,90 @@ C64Memory::_reset(bool hard)
     }
 }
 
+isize
+C64Memory::_load(const u8 *buffer)
+{
+    // Keep the current Rom accessible (the snapshot may refer to it)
+    storeRom();
+    
+    util::SerReader reader(buffer);
+    applyToPersistentItems(reader);
+    applyToResetItems(reader);
+    
+    // Fetch the Rom contents recorded in the snapshot
+    restoreRom();
+    
+    trace(SNP_DEBUG, "Recreated from %ld bytes\n", reader.ptr - buffer);
+    return reader.ptr - buffer;
+}
+
+isize
+C64Memory::_save(u8 *buffer)
+{
+    // Make sure that the snapshot refers to the current Rom contents
+    storeRom();
+    
+    util::SerWriter writer(buffer);
+    applyToPersistentItems(writer);
+    applyToResetItems(writer);
+    
+    trace(SNP_DEBUG, "Serialized to %ld bytes\n", writer.ptr - buffer);
+    return writer.ptr - buffer;
+}
+
+isize
+C64Memory::_deltaSize()
+{
+    util::SerCounter counter;
+    applyToDeltaItems(counter);
+    
+    return counter.count + ramDirty.deltaSize() + romDirty.deltaSize();
+}
+
+isize
+C64Memory::_loadDelta(const u8 *buffer, const u8 *end)
+{
+    util::SerCounter counter;
+    applyToDeltaItems(counter);
+    if (counter.count > end - buffer) throw VC64Error(ERROR_SNP_CORRUPTED);
+
+    util::SerReader reader(buffer);
+    applyToDeltaItems(reader);
+    
+    isize ramCount = ramDirty.loadDelta(ram, reader.ptr, end);
+    if (ramCount < 0) throw VC64Error(ERROR_SNP_CORRUPTED);
+    reader.ptr += ramCount;
+    
+    isize romCount = romDirty.loadDelta(rom, reader.ptr, end);
+    if (romCount < 0) throw VC64Error(ERROR_SNP_CORRUPTED);
+    reader.ptr += romCount;
+    romKey = 0;
+    
+    trace(SNP_DEBUG, "Recreated from %ld delta bytes\n", reader.ptr - buffer);
+    return reader.ptr - buffer;
+}
+
+isize
+C64Memory::didLoadFromBuffer(const u8 *buffer)
+{
+    // The page tables are not part of the snapshot
+    updatePageTables();
+    return 0;
+}
+
+isize
+C64Memory::_saveDelta(u8 *buffer)
+{
+    util::SerWriter writer(buffer);
+    applyToDeltaItems(writer);
+    
+    writer.ptr += ramDirty.saveDelta(ram, writer.ptr);
+    writer.ptr += romDirty.saveDelta(rom, writer.ptr);
+    
+    trace(SNP_DEBUG, "Serialized to %ld delta bytes\n", writer.ptr - buffer);
+    return writer.ptr - buffer;
+}
+
 MemConfig
 C64Memory::getDefaultConfig()
 {
@@ -274,6 +360,27 @@ C64Memory::eraseWithPattern(RamPattern pattern)
         default:
             fatalError;
     }
+    
+    ramDirty.markAll();
+}
+
+void
+C64Memory::storeRom()
+{
+    if (romKey == 0) romKey = util::RomStore::shared().add(rom, sizeof(rom));
+}
+
+void
+C64Memory::restoreRom()
+{
+    if (!util::RomStore::shared().restore(romKey, rom, sizeof(rom))) {
+        
+        warn("Rom %llx is not available in the Rom store\n", romKey);
+        memset(rom, 0, sizeof(rom));
+        romKey = 0;
+        c64.missingRoms++;
+    }
+    romDirty.markAll();
 }
 
 void 
@@ -294,6 +401,46 @@ C64Memory::updatePeekPokeLookupTables()
     
     // Call the Cartridge's delegation method
     expansionport.updatePeekPokeLookupTables();
+    
+    // Derive the page tables
+    updatePageTables();
+}
+
+void
+C64Memory::updatePageTables()
+{
+    for (isize page = 0; page < 256; page++) {
+        
+        peekPage[page] = nullptr;
+        pokePage[page] = nullptr;
+        
+        // Watchpoints are checked in the lookup table based functions only
+        if (checkWatchpoints) continue;
+        
+        switch (peekSrc[page >> 4]) {
+                
+            case M_PP:      if (page) peekPage[page] = ram; break;
+            case M_RAM:     peekPage[page] = ram; break;
+            case M_BASIC:
+            case M_CHAR:
+            case M_KERNAL:  peekPage[page] = rom; break;
+                
+            default:
+                break;
+        }
+        
+        switch (pokeTarget[page >> 4]) {
+                
+            case M_PP:      if (page) pokePage[page] = ram; break;
+            case M_RAM:
+            case M_BASIC:
+            case M_CHAR:
+            case M_KERNAL:  pokePage[page] = ram; break;
+                
+            default:
+                break;
+        }
+    }
 }
 
 u8
@@ -539,7 +686,7 @@ C64Memory::poke(u16 addr, u8 value, MemoryType target)
         case M_CHAR:
         case M_KERNAL:
             
-            ram[addr] = value;
+            pokeRam(addr, value);
             return;
             
         case M_IO:
@@ -556,7 +703,7 @@ C64Memory::poke(u16 addr, u8 value, MemoryType target)
         case M_PP:
             
             if (likely(addr >= 0x02)) {
-                ram[addr] = value;
+                pokeRam(addr, value);
             } else if (addr == 0x00) {
                 cpu.pport.writeDirection(value);
             } else {
@@ -589,7 +736,7 @@ C64Memory::pokeZP(u8 addr, u8 value)
     CHECK_WATCHPOINT(addr)
     
     if (likely(addr >= 0x02)) {
-        ram[addr] = value;
+        pokeRam(addr, value);
     } else if (addr == 0x00) {
         cpu.pport.writeDirection(value);
     } else {
@@ -602,7 +749,7 @@ C64Memory::pokeStack(u8 sp, u8 value)
 {
     CHECK_WATCHPOINT(sp)
     
-    ram[0x100 + sp] = value;
+    pokeRam(0x100 + sp, value);
 }
 
 void
@@ -11,6 +11,7 @@
 
 #include "MemoryTypes.h"
 #include "SubComponent.h"
+#include "DirtyPages.h"
 
 class C64Memory : public SubComponent {
 
@@ -48,13 +49,31 @@ public:
      * addresses are valid ROM addresses.
      */
     u8 rom[65536];
+    
+    /* Key of the Rom contents in the Rom store. Snapshots only record this key
+     * instead of the Rom data. A value of 0 indicates that the key has not
+     * been computed yet.
+     */
+    u64 romKey = 0;
         
+    // Pages of RAM and ROM that have been modified since the last delta snapshot
+    util::DirtyPages ramDirty = util::DirtyPages(sizeof(ram));
+    util::DirtyPages romDirty = util::DirtyPages(sizeof(rom));
+
     // Peek source lookup table
     MemoryType peekSrc[16];
     
     // Poke target lookup table
     MemoryType pokeTarget[16];
     
+    /* Page tables (derived from the lookup tables above). For each 256 byte
+     * page, the tables point to the memory block backing that page. Pages
+     * that are mapped to I/O space, the cartridge, or the processor port
+     * have a nullptr entry and are handled by the lookup tables.
+     */
+    const u8 *peekPage[256];
+    u8 *pokePage[256];
+    
     // Indicates if watchpoints should be checked
     bool checkWatchpoints = false;
     
@@ -93,7 +112,7 @@ private:
         
         << ram
         << colorRam
-        << rom
+        << romKey
         << peekSrc
         << pokeTarget;
     }
@@ -103,9 +122,26 @@ private:
     {
     }
     
+    // Items stored in delta snapshots in addition to the modified pages
+    template <class T>
+    void applyToDeltaItems(T& worker)
+    {
+        worker
+        
+        << colorRam
+        << peekSrc
+        << pokeTarget;
+    }
+    
     isize _size() override { COMPUTE_SNAPSHOT_SIZE }
-    isize _load(const u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
-    isize _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    isize _load(const u8 *buffer) override;
+    isize _save(u8 *buffer) override;
+    isize _deltaSize() override;
+    isize _loadDelta(const u8 *buffer, const u8 *end) override;
+    isize _saveDelta(u8 *buffer) override;
+    void _markDirty() override { ramDirty.markAll(); romDirty.markAll(); }
+    void _markClean() override { ramDirty.clear(); romDirty.clear(); }
+    isize didLoadFromBuffer(const u8 *buffer) override;
     
     
     //
@@ -144,11 +180,29 @@ public:
     // Erases the RAM with the provided init pattern
     void eraseWithPattern(RamPattern pattern);
     
+    // Needs to be called whenever the Rom contents have been modified
+    void romDidChange() { romDirty.markAll(); romKey = 0; }
+    
+private:
+    
+    // Adds the Rom contents to the Rom store (if not done yet)
+    void storeRom();
+    
+    // Replaces the Rom contents by the image recorded in the Rom store
+    void restoreRom();
+    
+public:
+    
     /* Updates the peek and poke lookup tables. The lookup values depend on
      * three processor port bits and the cartridge exrom and game lines.
      */
     void updatePeekPokeLookupTables();
 
+    /* Updates the page tables. This function needs to be called whenever the
+     * lookup tables or the watchpoint flag have changed.
+     */
+    void updatePageTables();
+
     // Returns the current peek source of the specified memory address
     MemoryType getPeekSource(u16 addr) { return peekSrc[addr >> 12]; }
     
@@ -158,7 +212,10 @@ public:
     // Reads a value from memory
     u8 peek(u16 addr, MemoryType source);
     u8 peek(u16 addr, bool gameLine, bool exromLine);
-    u8 peek(u16 addr) { return peek(addr, peekSrc[addr >> 12]); }
+    u8 peek(u16 addr) {
+        if (const u8 *p = peekPage[addr >> 8]) return p[addr];
+        return peek(addr, peekSrc[addr >> 12]);
+    }
     u8 peekZP(u8 addr);
     u8 peekStack(u8 sp);
     u8 peekIO(u16 addr);
@@ -175,10 +232,16 @@ public:
     u8 spypeekIO(u16 addr) const;
     u8 spypeekColor(u16 addr) const;
 
+    // Writes a value into RAM, bypassing the bank map
+    void pokeRam(u16 addr, u8 value) { ram[addr] = value; ramDirty.mark(addr); }
+
     // Writing a value into memory
     void poke(u16 addr, u8 value, MemoryType target);
     void poke(u16 addr, u8 value, bool gameLine, bool exromLine);
-    void poke(u16 addr, u8 value) { poke(addr, value, pokeTarget[addr >> 12]); }
+    void poke(u16 addr, u8 value) {
+        if (u8 *p = pokePage[addr >> 8]) { p[addr] = value; ramDirty.mark(addr); return; }
+        poke(addr, value, pokeTarget[addr >> 12]);
+    }
     void pokeZP(u8 addr, u8 value);
     void pokeStack(u8 sp, u8 value);
     void pokeIO(u16 addr, u8 value);
@@ -11,6 +11,8 @@
 #include "DiskAnalyzer.h"
 #include "Disk.h"
 
+#include <cstdarg>
+
 /*
 u8
 DiskAnalyzer::decodeGcrNibble(u8 *gcr)
@@ -10,6 +10,7 @@
 #include "config.h"
 #include "Drive.h"
 #include "C64.h"
+#include "FSDevice.h"
 #include "IO.h"
 
 Drive::Drive(DriveID id, C64 &ref) : SubComponent(ref), deviceNr(id)
@@ -51,6 +52,8 @@ Drive::_reset(bool hard)
     halftrack = 41;
     
     needsEmulation = config.connected && config.switchedOn;
+    sleeping = false;
+    loopPC = -1;
 }
 
 DriveConfig
@@ -63,6 +66,7 @@ Drive::getDefaultConfig()
     defaults.ram = DRVRAM_NONE;
     defaults.parCable = PAR_CABLE_NONE;
     defaults.powerSave = true;
+    defaults.accelerate = false;
     defaults.connected = false;
     defaults.switchedOn = true;
     defaults.ejectDelay = 30;
@@ -90,6 +94,7 @@ Drive::resetConfig()
     try { setConfigItem(OPT_DRV_CONNECT, deviceNr == DRIVE8); } catch (...) { }
     setConfigItem(OPT_DRV_POWER_SWITCH, defaults.switchedOn);
     setConfigItem(OPT_DRV_POWER_SAVE, defaults.powerSave);
+    setConfigItem(OPT_DRV_ACCELERATE, defaults.accelerate);
 
     setConfigItem(OPT_DRV_EJECT_DELAY, defaults.ejectDelay);
     setConfigItem(OPT_DRV_SWAP_DELAY, defaults.swapDelay);
@@ -114,6 +119,7 @@ Drive::getConfigItem(Option option) const
         case OPT_DRV_CONNECT:       return (i64)config.connected;
         case OPT_DRV_POWER_SWITCH:  return (i64)config.switchedOn;
         case OPT_DRV_POWER_SAVE:    return (i64)config.powerSave;
+        case OPT_DRV_ACCELERATE:    return (i64)config.accelerate;
         case OPT_DRV_EJECT_DELAY:   return (i64)config.ejectDelay;
         case OPT_DRV_SWAP_DELAY:    return (i64)config.swapDelay;
         case OPT_DRV_INSERT_DELAY:  return (i64)config.insertDelay;
@@ -159,6 +165,7 @@ Drive::setConfigItem(Option option, i64 value)
             
             suspended {
                 
+                wakeUp();
                 config.ram = (DriveRam)value;
                 mem.updateBankMap();
             }
@@ -172,6 +179,7 @@ Drive::setConfigItem(Option option, i64 value)
             
             suspended {
 
+                wakeUp();
                 config.parCable = (ParCableType)value;
                 mem.updateBankMap();
             }
@@ -210,6 +218,11 @@ Drive::setConfigItem(Option option, i64 value)
             }
             return;
 
+        case OPT_DRV_ACCELERATE:
+
+            config.accelerate = value;
+            return;
+
         case OPT_DRV_EJECT_DELAY:
 
             config.ejectDelay = value;
@@ -336,6 +349,8 @@ Drive::_dump(dump::Category category, std::ostream& os) const
         os << ParCableTypeEnum::key(config.parCable) << std::endl;
         os << tab("Power save mode");
         os << bol(config.powerSave, "when idle", "never") << std::endl;
+        os << tab("Accelerate");
+        os << bol(config.accelerate, "Kernal LOAD", "never") << std::endl;
         os << tab("Connected");
         os << bol(config.connected) << std::endl;
         os << tab("Power switch");
@@ -358,6 +373,12 @@ Drive::_dump(dump::Category category, std::ostream& os) const
          
         os << tab("Idle");
         os << bol(isIdle()) << std::endl;
+        os << tab("Idle loop");
+        if (sleeping) {
+            os << hex((u16)loopPC) << " (" << dec(loopLength) << " cycles)" << std::endl;
+        } else {
+            os << "none" << std::endl;
+        }
         os << tab("Motor");
         os << bol(isRotating(), "on", "off") << std::endl;
         os << tab("Has disk");
@@ -416,6 +437,8 @@ Drive::_load(const u8 *buffer)
     // Read own state
     applyToPersistentItems(reader);
     applyToResetItems(reader);
+    sleeping = false;
+    loopPC = -1;
 
     // Check if the snapshot includes a disk
     bool diskInSnapshot; reader << diskInSnapshot;
@@ -465,6 +488,13 @@ Drive::execute(u64 duration)
 {
     elapsedTime += duration;
     
+    // Check if the drive CPU is trapped in an idle loop
+    if (sleeping) {
+        
+        if ((i64)elapsedTime <= wakeUpTime) return;
+        awake();
+    }
+    
     while (nextClock < (i64)elapsedTime || nextCarry < (i64)elapsedTime) {
 
         if (nextClock <= nextCarry) {
@@ -478,6 +508,34 @@ Drive::execute(u64 duration)
             if (iec.isDirtyDriveSide) iec.updateIecLinesDriveSide();
 
             nextClock += 10000;
+            
+            // Check if the CPU has completed an iteration of an idle loop
+            if (!DRV_ON_STEROIDS && cpu.inFetchPhase()) {
+                
+                if (cpu.reg.pc == loopPC || (i64)(cycle - loopCycle) > maxLoopLength) {
+                    
+                    /* Skip loop detection as long as the drive can't sleep
+                     * anyway. Otherwise, comparing and recording the loop
+                     * state would cost a Ram copy per iteration of the
+                     * tight loops that run while the motor spins.
+                     */
+                    if (!canSleep()) {
+                        
+                        loopPC = -1;
+                        loopCycle = cycle;
+                        
+                    } else {
+                        
+                        if (cpu.reg.pc == loopPC && matchesLoopState()) {
+                            
+                            loopLength = (i64)(cycle - loopCycle);
+                            sleep();
+                            if (sleeping) return;
+                        }
+                        recordLoopState();
+                    }
+                }
+            }
 
         } else {
             
@@ -683,6 +741,13 @@ Drive::setRotating(bool b)
 void
 Drive::wakeUp()
 {
+    // Emulate all cycles that have been skipped in an idle loop
+    if (sleeping) {
+        
+        awake();
+        execute(0);
+    }
+    
     if (isIdle()) {
         
         trace(DRV_DEBUG, "Exiting power-safe mode\n");
@@ -855,6 +920,124 @@ Drive::vsyncHandler()
     }
 }
 
+bool
+Drive::canSleep() const
+{
+    return
+    !spinning &&
+    config.ram == DRVRAM_NONE &&
+    config.parCable == PAR_CABLE_NONE &&
+    cpu.cycle >= 1500000 && // Light barrier (see getLightBarrier())
+    !cpu.irqLine && !cpu.nmiLine && !cpu.interruptPending() &&
+    !iec.isDirtyDriveSide &&
+    via1.isPeriodic() && via2.isPeriodic();
+}
+
+void
+Drive::recordLoopState()
+{
+    loopPC = cpu.reg.pc;
+    loopCycle = cpu.cycle;
+    loopRegs = cpu.reg;
+    loopVia1 = via1.getIdleState();
+    loopVia2 = via2.getIdleState();
+    via1.timerPeeked = false;
+    via2.timerPeeked = false;
+    std::memcpy(loopRam, mem.ram, sizeof(loopRam));
+}
+
+bool
+Drive::matchesLoopState() const
+{
+    auto &r = cpu.reg;
+    auto &s = loopRegs;
+    
+    // Compare the CPU registers
+    if (r.a != s.a || r.x != s.x || r.y != s.y || r.sp != s.sp) return false;
+    if (r.adl != s.adl || r.adh != s.adh || r.idl != s.idl || r.d != s.d) return false;
+    if (r.ovl != s.ovl || r.pc0 != s.pc0) return false;
+    if (r.sr.n != s.sr.n || r.sr.v != s.sr.v || r.sr.b != s.sr.b ||
+        r.sr.d != s.sr.d || r.sr.i != s.sr.i || r.sr.z != s.sr.z ||
+        r.sr.c != s.sr.c) return false;
+
+    // The loop must not depend on the timer counters
+    if (via1.timerPeeked || via2.timerPeeked) return false;
+    
+    // Compare the VIA states
+    if (!(via1.getIdleState() == loopVia1)) return false;
+    if (!(via2.getIdleState() == loopVia2)) return false;
+    
+    // Compare RAM
+    return std::memcmp(loopRam, mem.ram, sizeof(loopRam)) == 0;
+}
+
+void
+Drive::sleep()
+{
+    // Determine how many cycles can be skipped without a timer underflow
+    u64 limit = std::min(via1.cyclesToUnderflow(), via2.cyclesToUnderflow());
+    sleepLimit = (i64)std::min(limit, (u64)maxSleepCycles);
+    
+    // Only proceed if at least one loop iteration can be skipped
+    if (sleepLimit < 2 * loopLength) return;
+    
+    trace(DRV_DEBUG, "Idle loop at %04X (%lld cycles)\n", cpu.reg.pc, loopLength);
+
+    sleeping = true;
+    wakeUpTime = nextClock + (sleepLimit - 1) * 10000;
+}
+
+void
+Drive::awake()
+{
+    assert(sleeping);
+    sleeping = false;
+    
+    // Determine the number of pending cycles
+    i64 pending = std::max((i64)elapsedTime - nextClock + 9999, (i64)0) / 10000;
+    
+    // Skip as many loop iterations as possible
+    i64 skip = std::min(pending, sleepLimit) / loopLength * loopLength;
+    
+    if (skip) {
+        
+        u64 start = cpu.cycle;
+        u64 end = start + skip;
+        
+        // Keep the VIA timers running
+        for (VIA6522 *via : { (VIA6522 *)&via1, (VIA6522 *)&via2 }) {
+            
+            for (u64 cycle = start + 1; cycle <= end;) {
+                
+                if (cycle >= via->wakeUpCycle) {
+                    
+                    cpu.cycle = cycle++;
+                    via->execute();
+                    
+                } else {
+                    
+                    u64 idle = std::min(via->wakeUpCycle, end + 1) - cycle;
+                    via->idleCounter += idle;
+                    cycle += idle;
+                }
+            }
+        }
+        cpu.cycle = end;
+        cpu.shiftInterruptLines(start - loopLength, skip);
+        
+        // Advance the clocking logic
+        nextClock += skip * 10000;
+        if (nextCarry < nextClock) {
+            
+            i64 delay = delayBetweenTwoCarryPulses[zone];
+            nextCarry += (nextClock - nextCarry + delay - 1) / delay * delay;
+        }
+    }
+    
+    // Restart idle loop detection
+    recordLoopState();
+}
+
 void
 Drive::executeStateTransition()
 {
@@ -920,3 +1103,125 @@ Drive::executeStateTransition()
             fatalError;
     }
 }
+
+bool
+Drive::serveLoad()
+{
+    auto &c64mem = c64.mem;
+    auto &c64cpu = c64.cpu;
+    
+    // Only proceed if this drive is accelerated and has a disk
+    if (!config.accelerate || !connectedAndOn() || !hasDisk()) return false;
+    
+    // Only proceed if the stock LOAD routine is mapped in (STA $93)
+    if (c64mem.getPeekSource(0xF4A5) != M_KERNAL) return false;
+    if (c64mem.spypeek(0xF4A5) != 0x85 || c64mem.spypeek(0xF4A6) != 0x93) return false;
+
+    // Only proceed if the request addresses this drive
+    if (c64mem.spypeek(0xBA) != deviceNr) return false;
+    
+    // Only proceed for LOAD requests (VERIFY is left to the drive)
+    if (c64cpu.reg.a != 0) return false;
+    
+    // Only proceed if the drive is not executing custom code
+    if (!runsDOS()) return false;
+    
+    // Read the file name
+    u8 name[256];
+    isize length = c64mem.spypeek(0xB7);
+    u16 ptr = LO_HI(c64mem.spypeek(0xBB), c64mem.spypeek(0xBC));
+    for (isize i = 0; i < length; i++) name[i] = c64mem.spypeek(u16(ptr + i));
+
+    // Strip off a drive prefix such as "0:" or ":"
+    isize first = 0;
+    for (isize i = 0; i < length && i < 2; i++) {
+        if (name[i] == ':') { first = i + 1; break; }
+    }
+    
+    // Strip off file type and access mode suffixes such as ",P,R"
+    isize last = first;
+    while (last < length && name[last] != ',') last++;
+    
+    // Leave directory requests and empty names to the drive
+    if (last == first || name[first] == '$') return false;
+    
+    try {
+        
+        // Decode the disk
+        FSDevice fs(*disk);
+        fs.scanDirectory();
+        
+        // Search the file
+        FSDirEntry *entry = nullptr;
+        for (auto &it : fs.dir) {
+            
+            if (matches(name + first, last - first, it->fileName)) { entry = it; break; }
+        }
+        if (!entry || entry->getFileType() != FS_FILETYPE_PRG) return false;
+        
+        // Read the file
+        auto size = fs.fileSize(entry);
+        if (size < 3) return false;
+        std::vector<u8> data(size);
+        fs.copyFile(entry, data.data(), size);
+
+        trace(DRV_DEBUG, "Serving LOAD from disk image (%llu bytes)\n", size);
+
+        // Determine the load address (secondary address 0 = address in X/Y)
+        u8 sa = c64mem.spypeek(0xB9);
+        u16 addr = sa ? LO_HI(data[0], data[1]) : LO_HI(c64mem.spypeek(0xC3), c64mem.spypeek(0xC4));
+        
+        // Leave files overlapping the I/O space to the drive
+        for (usize i = 0; i < size - 2; i += 0x100) {
+            if (c64mem.getPokeTarget(u16(addr + i)) == M_IO) return false;
+        }
+        if (c64mem.getPokeTarget(u16(addr + size - 3)) == M_IO) return false;
+
+        // Copy the file into memory
+        for (usize i = 2; i < size; i++) c64mem.poke(addr++, data[i]);
+        
+        // Update the Kernal variables (verify flag, status, SA, end address)
+        c64mem.poke(0x93, 0x00);
+        c64mem.poke(0x90, 0x40);
+        c64mem.poke(0xB9, 0x60);
+        c64mem.poke(0xAE, LO_BYTE(addr));
+        c64mem.poke(0xAF, HI_BYTE(addr));
+        
+        // Return to the caller with the end address in X/Y and C cleared
+        c64cpu.reg.x = LO_BYTE(addr);
+        c64cpu.reg.y = HI_BYTE(addr);
+        c64cpu.reg.sr.c = false;
+        u8 lo = c64mem.peekStack(++c64cpu.reg.sp);
+        u8 hi = c64mem.peekStack(++c64cpu.reg.sp);
+        c64cpu.reg.pc = LO_HI(lo, hi) + 1;
+
+        return true;
+        
+    } catch (VC64Error &err) {
+        
+        trace(DRV_DEBUG, "Unable to decode disk: %s\n", err.what());
+        return false;
+    }
+}
+
+bool
+Drive::runsDOS() const
+{
+    return mem.usage[cpu.reg.pc >> 10] == DRVMEM_ROM;
+}
+
+bool
+Drive::matches(const u8 *pattern, isize length, const u8 *name)
+{
+    for (isize i = 0; i < 16; i++) {
+        
+        // A wildcard matches the rest of the name
+        if (i < length && pattern[i] == '*') return true;
+        
+        // Names are padded with $A0
+        if (i >= length) return name[i] == 0xA0;
+        
+        if (pattern[i] != '?' && pattern[i] != name[i]) return false;
+    }
+    return length <= 16 || pattern[16] == '*';
+}
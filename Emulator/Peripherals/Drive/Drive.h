@@ -219,6 +219,48 @@ public:
     bool needsEmulation = false; 
     
     
+    //
+    // Speed logic (idle loops)
+    //
+    
+    /* Idle loop detection is disabled by default (see DRV_ON_STEROIDS in
+     * config.h). It has yet to be verified against a real 1541 Rom in
+     * lockstep with an always-awake drive.
+     */
+    
+private:
+    
+    // Maximum length of a detectable idle loop in cycles
+    static constexpr i64 maxLoopLength = 2048;
+    
+    // Maximum number of cycles to skip in a row
+    static constexpr i64 maxSleepCycles = 1000000;
+    
+    // Indicates whether the drive CPU is trapped in an idle loop
+    bool sleeping = false;
+    
+    // Skipped cycles are emulated when the elapsed time exceeds this value
+    i64 wakeUpTime = 0;
+    
+    // Maximum number of cycles that can be skipped without a VIA event
+    i64 sleepLimit = 0;
+    
+    // Number of cycles in a single iteration of the idle loop
+    i64 loopLength = 0;
+    
+    /* Reference state for idle loop detection. When the CPU reaches the
+     * recorded program counter again and the rest of the state matches, too,
+     * the drive keeps executing the same loop until a VIA timer underflows or
+     * an IEC line changes.
+     */
+    isize loopPC = -1;
+    u64 loopCycle = 0;
+    Registers loopRegs = {};
+    VIAIdleState loopVia1 = {};
+    VIAIdleState loopVia2 = {};
+    u8 loopRam[0x800] = {};
+    
+    
     //
     // Initializing
     //
@@ -257,6 +299,7 @@ private:
         << config.ram
         << config.parCable
         << config.powerSave
+        << config.accelerate
         << config.connected
         << config.switchedOn
         << config.ejectDelay
@@ -415,6 +458,21 @@ private:
     // Emulates a trigger event on the carry output pin of UE7.
     void executeUF4();
     
+    // Checks whether the drive runs in a loop that can be skipped
+    bool canSleep() const;
+    
+    // Records the reference state for idle loop detection
+    void recordLoopState();
+    
+    // Checks whether the current state equals the reference state
+    bool matchesLoopState() const;
+    
+    // Stops emulating the drive until the next VIA or IEC event
+    void sleep();
+    
+    // Fast-forwards the drive over all skipped loop iterations
+    void awake();
+    
 public:
 
     // Returns the current access mode of this drive (read or write)
@@ -474,4 +532,31 @@ private:
     
     // Execute the disk state transition for a single frame
     void executeStateTransition();    
+
+
+    //
+    // Accelerating
+    //
+
+public:
+
+    /* Serves a Kernal LOAD request directly from the disk image. This function
+     * is called by the C64 CPU when it enters the Kernal's LOAD routine. If
+     * the request addresses this drive and acceleration is enabled, the file
+     * is looked up in the decoded disk image and copied into memory. On
+     * success, the CPU state is adjusted as if the Kernal routine had been
+     * executed and true is returned. In all other cases (unknown Kernal,
+     * drive executing code in RAM, directory requests, missing files, etc.),
+     * the function returns false and the request is processed by the
+     * emulated drive as usual.
+     */
+    bool serveLoad();
+
+private:
+
+    // Checks whether the drive CPU is executing the DOS in ROM
+    bool runsDOS() const;
+
+    // Checks if a CBM DOS file name pattern matches a directory entry
+    static bool matches(const u8 *pattern, isize length, const u8 *name);
 };
@@ -12,6 +12,7 @@
 #include "C64.h"
 #include "Checksum.h"
 #include "IO.h"
+#include "RomStore.h"
 
 DriveMemory::DriveMemory(C64 &ref, Drive &dref) : SubComponent(ref), drive(dref)
 {
@@ -27,6 +28,83 @@ DriveMemory::_reset(bool hard)
     for (isize i = 0; i < isizeof(ram); i++) {
         ram[i] = (i & 64) ? 0xFF : 0x00;
     }
+    ramDirty.markAll();
+}
+
+isize
+DriveMemory::_load(const u8 *buffer)
+{
+    // Keep the current Rom accessible (the snapshot may refer to it)
+    storeRom();
+    
+    util::SerReader reader(buffer);
+    applyToPersistentItems(reader);
+    applyToResetItems(reader);
+    
+    // Fetch the Rom contents recorded in the snapshot
+    restoreRom();
+    
+    trace(SNP_DEBUG, "Recreated from %ld bytes\n", reader.ptr - buffer);
+    return reader.ptr - buffer;
+}
+
+isize
+DriveMemory::_save(u8 *buffer)
+{
+    // Make sure that the snapshot refers to the current Rom contents
+    storeRom();
+    
+    util::SerWriter writer(buffer);
+    applyToPersistentItems(writer);
+    applyToResetItems(writer);
+    
+    trace(SNP_DEBUG, "Serialized to %ld bytes\n", writer.ptr - buffer);
+    return writer.ptr - buffer;
+}
+
+isize
+DriveMemory::_deltaSize()
+{
+    util::SerCounter counter;
+    applyToDeltaItems(counter);
+    
+    return counter.count + ramDirty.deltaSize() + romDirty.deltaSize();
+}
+
+isize
+DriveMemory::_loadDelta(const u8 *buffer, const u8 *end)
+{
+    util::SerCounter counter;
+    applyToDeltaItems(counter);
+    if (counter.count > end - buffer) throw VC64Error(ERROR_SNP_CORRUPTED);
+
+    util::SerReader reader(buffer);
+    applyToDeltaItems(reader);
+    
+    isize ramCount = ramDirty.loadDelta(ram, reader.ptr, end);
+    if (ramCount < 0) throw VC64Error(ERROR_SNP_CORRUPTED);
+    reader.ptr += ramCount;
+    
+    isize romCount = romDirty.loadDelta(rom, reader.ptr, end);
+    if (romCount < 0) throw VC64Error(ERROR_SNP_CORRUPTED);
+    reader.ptr += romCount;
+    romKey = 0;
+    
+    trace(SNP_DEBUG, "Recreated from %ld delta bytes\n", reader.ptr - buffer);
+    return reader.ptr - buffer;
+}
+
+isize
+DriveMemory::_saveDelta(u8 *buffer)
+{
+    util::SerWriter writer(buffer);
+    applyToDeltaItems(writer);
+    
+    writer.ptr += ramDirty.saveDelta(ram, writer.ptr);
+    writer.ptr += romDirty.saveDelta(rom, writer.ptr);
+    
+    trace(SNP_DEBUG, "Serialized to %ld delta bytes\n", writer.ptr - buffer);
+    return writer.ptr - buffer;
 }
 
 void
@@ -108,10 +186,31 @@ DriveMemory::romFNV64() const
     return size ? util::fnv_1a_64(rom + offset, size) : 0;
 }
 
+void
+DriveMemory::storeRom()
+{
+    if (romKey == 0) romKey = util::RomStore::shared().add(rom, sizeof(rom));
+}
+
+void
+DriveMemory::restoreRom()
+{
+    if (!util::RomStore::shared().restore(romKey, rom, sizeof(rom))) {
+        
+        warn("Rom %llx is not available in the Rom store\n", romKey);
+        memset(rom, 0, sizeof(rom));
+        romKey = 0;
+        c64.missingRoms++;
+    }
+    romDirty.markAll();
+}
+
 void
 DriveMemory::deleteRom()
 {
     memset(rom, 0, sizeof(rom));
+    romDirty.markAll();
+    romKey = 0;
     updateBankMap();
 }
 
@@ -269,11 +368,13 @@ DriveMemory::poke(u16 addr, u8 value)
         case DRVMEM_RAM:
             
             ram[addr & 0x07FF] = value;
+            ramDirty.mark(addr & 0x07FF);
             break;
             
         case DRVMEM_EXP:
             
             ram[addr] = value;
+            ramDirty.mark(addr);
             break;
             
         case DRVMEM_VIA1:
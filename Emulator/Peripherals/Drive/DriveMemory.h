@@ -11,6 +11,7 @@
 
 #include "SubComponent.h"
 #include "DriveTypes.h"
+#include "DirtyPages.h"
 
 class DriveMemory : public SubComponent {
     
@@ -35,6 +36,13 @@ public:
      */
     u8 ram[0xA000];
     u8 rom[0x8000] = {};
+    
+    // Key of the Rom contents in the Rom store (0 = not computed yet)
+    u64 romKey = 0;
+    
+    // Pages of RAM and ROM that have been modified since the last delta snapshot
+    util::DirtyPages ramDirty = util::DirtyPages(sizeof(ram));
+    util::DirtyPages romDirty = util::DirtyPages(sizeof(rom));
             
     // Memory usage table (one entry for each KB)
     DrvMemType usage[64];
@@ -73,7 +81,7 @@ private:
         worker
         
         << ram
-        << rom
+        << romKey
         << usage;
     }
     
@@ -82,9 +90,23 @@ private:
     {
     }
     
+    // Items stored in delta snapshots in addition to the modified pages
+    template <class T>
+    void applyToDeltaItems(T& worker)
+    {
+        worker
+        
+        << usage;
+    }
+    
     isize _size() override { COMPUTE_SNAPSHOT_SIZE }
-    isize _load(const u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
-    isize _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    isize _load(const u8 *buffer) override;
+    isize _save(u8 *buffer) override;
+    isize _deltaSize() override;
+    isize _loadDelta(const u8 *buffer, const u8 *end) override;
+    isize _saveDelta(u8 *buffer) override;
+    void _markDirty() override { ramDirty.markAll(); romDirty.markAll(); }
+    void _markClean() override { ramDirty.clear(); romDirty.clear(); }
     
     
     //
@@ -113,6 +135,14 @@ public:
     
     // Saves the currently installed Rom
     void saveRom(const string &path) throws;
+    
+private:
+    
+    // Adds the Rom contents to the Rom store (if not done yet)
+    void storeRom();
+    
+    // Replaces the Rom contents by the image recorded in the Rom store
+    void restoreRom();
 
     
     //
@@ -137,8 +167,8 @@ public:
 
     // Writes a value into memory
     void poke(u16 addr, u8 value);
-    void pokeZP(u8 addr, u8 value) { ram[addr] = value; }
-    void pokeStack(u8 sp, u8 value) { ram[0x100 + sp] = value; }
+    void pokeZP(u8 addr, u8 value) { ram[addr] = value; ramDirty.mark(addr); }
+    void pokeStack(u8 sp, u8 value) { ram[0x100 + sp] = value; ramDirty.mark(0x100 + sp); }
         
     // Updates the bank map
     void updateBankMap();
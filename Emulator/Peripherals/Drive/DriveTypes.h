@@ -185,6 +185,7 @@ typedef struct
     DriveRam ram;
     ParCableType parCable;
     bool powerSave;
+    bool accelerate;
 
     // State
     bool connected;
@@ -30,6 +30,7 @@ void VIA6522::_reset(bool hard)
     t1_latch_lo = 0x05; // Makes "drive/defaults.prg" happy
     t2_latch_lo = 0xAA;
     feed = (VIACountA0 | VIACountB0);
+    timerPeeked = false;
 }
 
 void
@@ -235,6 +236,7 @@ VIA6522::peek(u16 addr)
              */
             clearInterruptFlag_T1();
             result = LO_BYTE(t1);
+            timerPeeked = true;
             break;
             
         case 0x5: // T1 high-order counter
@@ -242,6 +244,7 @@ VIA6522::peek(u16 addr)
             // "8 BITS FROM T1 HIGH-ORDER COUNTER TRANSFERRED TO MPU2" [F. K.]
             
             result = HI_BYTE(t1);
+            timerPeeked = true;
             break;
             
         case 0x6: // T1 low-order latch
@@ -264,12 +267,14 @@ VIA6522::peek(u16 addr)
             
             clearInterruptFlag_T2();
             result = LO_BYTE(t2);
+            timerPeeked = true;
             break;
             
         case 0x9: // T2 high-order counter COUNTER TRANSFERRED TO MPU" [F. K.]
             
             // "8 BITS FROM T2 HIGH-ORDER
             result = HI_BYTE(t2);
+            timerPeeked = true;
             break;
             
         case 0xA: // Shift register
@@ -886,6 +891,50 @@ VIA6522::wakeUp()
     wakeUpCycle = 0;
 }
 
+u64
+VIA6522::cyclesToUnderflow() const
+{
+    // Underflows only matter if the timer is counting and armed
+    bool armedA = ((delay | feed) & VIACountA0) && (freeRun() || !(feed & VIAPostOneShotA0));
+    bool armedB = ((delay | feed) & VIACountB0) && !(feed & VIAPostOneShotB0);
+    
+    u64 cyclesA = armedA ? t1 : UINT64_MAX;
+    u64 cyclesB = armedB ? t2 : UINT64_MAX;
+    
+    // Take the cycles into account that have been skipped while sleeping
+    u64 result = std::min(cyclesA, cyclesB);
+    if (result != UINT64_MAX) result -= idleCounter;
+    
+    // Keep a safety margin to the cycle where the counter reaches zero
+    return result > 2 ? result - 2 : 0;
+}
+
+VIAIdleState
+VIA6522::getIdleState() const
+{
+    return VIAIdleState {
+        
+        pa, pb, ddra, ddrb, ora, orb, ira, irb,
+        ca1, ca2, cb1, cb2,
+        t1_latch_lo, t1_latch_hi, t2_latch_lo,
+        pcr, acr, ier, ifr, sr,
+        delay, feed
+    };
+}
+
+bool
+VIAIdleState::operator==(const VIAIdleState &rhs) const
+{
+    return
+    pa == rhs.pa && pb == rhs.pb && ddra == rhs.ddra && ddrb == rhs.ddrb &&
+    ora == rhs.ora && orb == rhs.orb && ira == rhs.ira && irb == rhs.irb &&
+    ca1 == rhs.ca1 && ca2 == rhs.ca2 && cb1 == rhs.cb1 && cb2 == rhs.cb2 &&
+    t1_latch_lo == rhs.t1_latch_lo && t1_latch_hi == rhs.t1_latch_hi &&
+    t2_latch_lo == rhs.t2_latch_lo &&
+    pcr == rhs.pcr && acr == rhs.acr && ier == rhs.ier && ifr == rhs.ifr &&
+    sr == rhs.sr && delay == rhs.delay && feed == rhs.feed;
+}
+
 
 //
 // VIA 1
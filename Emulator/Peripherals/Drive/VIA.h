@@ -49,8 +49,27 @@
 #define VIAClrInterrupt0 (1ULL << 27) // Releases the interrupt line
 #define VIAClrInterrupt1 (1ULL << 28)
 
+/* Bits in the event triggering queue that keep the VIA state periodic. If no
+ * other bit is set, the timers are the only VIA components that change state.
+ */
+#define VIAIdleBits (VIACountA0 | VIACountA1 | VIACountB0 | VIACountB1 | VIAPostOneShotA0 | VIAPostOneShotB0 | VIAPB7out0)
+
 #define VIAClearBits ~((1ULL << 29) | VIACountA0 | VIACountB0 | VIAReloadA0 | VIAReloadB0 | VIAPostOneShotA0 | VIAPostOneShotB0 | VIAInterrupt0 | VIASetCA1out0 | VIAClearCA1out0 | VIASetCA2out0 | VIAClearCA2out0 | VIASetCB2out0 | VIAClearCB2out0 | VIAPB7out0 | VIAClrInterrupt0)
 
+/* VIA state without the timer counters. The drive takes snapshots of this
+ * structure to detect idle loops (see Drive::sleep()).
+ */
+struct VIAIdleState {
+    
+    u8 pa, pb, ddra, ddrb, ora, orb, ira, irb;
+    bool ca1, ca2, cb1, cb2;
+    u8 t1_latch_lo, t1_latch_hi, t2_latch_lo;
+    u8 pcr, acr, ier, ifr, sr;
+    u64 delay, feed;
+    
+    bool operator==(const VIAIdleState &rhs) const;
+};
+
 class VIA6522 : public SubComponent {
     
     friend class Drive;
@@ -207,6 +226,9 @@ protected:
     // Number of skipped executions
     u64 idleCounter;
     
+    // Indicates whether the timer counters have been read by the CPU
+    bool timerPeeked;
+    
     
     //
     // Initializing
@@ -507,6 +529,15 @@ public:
     
     // Emulates all previously skipped cycles
     void wakeUp();
+    
+    // Checks whether the timers are the only components that change state
+    bool isPeriodic() const { return ((delay | feed) & ~VIAIdleBits) == 0; }
+    
+    // Returns the number of cycles the VIA can run without a timer underflow
+    u64 cyclesToUnderflow() const;
+    
+    // Records the current state (excluding the timer counters)
+    VIAIdleState getIdleState() const;
 };
 
 
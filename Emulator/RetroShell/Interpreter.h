@@ -21,7 +21,7 @@ enum class Token
     
     // Components
     c64, cia, controlport, cpu, datasette, drive, expansion, fastsid, keyboard,
-    memory, monitor, mouse, parcable, resid, sid, vicii,
+    memory, monitor, mouse, parcable, profiler, resid, sid, vicii,
 
     // Commands
     about, attach, audiate, autosync, clear, close, config, connect, disconnect,
@@ -33,14 +33,14 @@ enum class Token
     checksums, devices, events, registers, state, disk,
     
     // Keys
-    accuracy, autofire, bankmap, brightness, bullets, caccesses, chip,
-    contrast, counter, cutout, defaultbb, defaultfs, delay, device, engine,
-    filename, filter, frame, gaccesses, gluelogic, graydotbug, iaccesses, idle,
-    joystick, keyset, left, model, newdisk, paccesses, palette, pan, poll,
-    raccesses, raminitpattern, revision, right, rom, saccesses, sampling,
-    saturation, sbcollisions, searchpath, shakedetector, shiftlock, slow,
-    slowramdelay, slowrammirror, speed, sscollisions, step, to, tod, timerbbug,
-    unmappingtype, velocity, volume
+    accelerate, accuracy, autofire, back, bankmap, brightness, budget, bullets, caccesses,
+    chip, contrast, counter, cutout, defaultbb, defaultfs, delay, device,
+    engine, filename, filter, frame, gaccesses, gluelogic, graydotbug,
+    iaccesses, idle, interval, joystick, keyset, left, model, newdisk,
+    paccesses, palette, pan, poll, raccesses, raminitpattern, revision, rgba, right,
+    rom, saccesses, sampling, saturation, sbcollisions, searchpath,
+    shakedetector, shiftlock, slow, slowramdelay, slowrammirror, speed,
+    sscollisions, step, to, tod, timerbbug, unmappingtype, velocity, volume
 };
 
 struct TooFewArgumentsError : public util::ParseError {
@@ -152,6 +152,61 @@ Interpreter::registerInstructions()
              &RetroShell::exec <Token::memory, Token::inspect>);
 
     
+    //
+    // Rewind buffer
+    //
+    
+    root.add({"rewind"},
+             "component", "Emulator state history");
+    
+    root.add({"rewind", "config"},
+             "command", "Displays the current configuration",
+             &RetroShell::exec <Token::rewind, Token::config>);
+
+    root.add({"rewind", "set"},
+             "command", "Configures the component");
+        
+    root.add({"rewind", "set", "interval"},
+             "key", "Number of frames between two recorded states (0 = off)",
+             &RetroShell::exec <Token::rewind, Token::set, Token::interval>, 1);
+
+    root.add({"rewind", "set", "budget"},
+             "key", "Maximum memory usage in MB",
+             &RetroShell::exec <Token::rewind, Token::set, Token::budget>, 1);
+
+    root.add({"rewind", "to"},
+             "command", "Reverts the emulator to the specified cycle",
+             &RetroShell::exec <Token::rewind, Token::to>, 1);
+
+    root.add({"rewind", "back"},
+             "command", "Reverts the emulator by the specified number of seconds",
+             &RetroShell::exec <Token::rewind, Token::back>, 1);
+
+    root.add({"rewind", "inspect"},
+             "command", "Displays the component state",
+             &RetroShell::exec <Token::rewind, Token::inspect>);
+
+
+    //
+    // Profiler
+    //
+    
+    root.add({"profiler"},
+             "component", "Host time consumption per component");
+    
+    root.add({"profiler", "inspect"},
+             "command", "Displays the gathered statistics",
+             &RetroShell::exec <Token::profiler, Token::inspect>);
+
+    root.add({"profiler", "clear"},
+             "command", "Discards the gathered statistics",
+             &RetroShell::exec <Token::profiler, Token::clear>);
+
+    root.add({"profiler", "save"},
+             "command", "Writes the gathered statistics to a JSON file",
+             &RetroShell::exec <Token::profiler, Token::save>, 1);
+
+    
     //
     // Drive
     //
@@ -176,6 +231,14 @@ Interpreter::registerInstructions()
                  "command", "Disconnects the drive",
                  &RetroShell::exec <Token::drive, Token::disconnect>);
         
+        root.add({drive, "set"},
+                 "command", "Configures the component");
+
+        root.add({drive, "set", "accelerate"},
+                 "key", "Serves Kernal LOAD requests directly from the disk image",
+                 &RetroShell::exec <Token::drive, Token::set, Token::accelerate>, 1,
+                 drive == "drive8" ? 0 : 1);
+
         root.add({drive, "eject"},
                  "command", "Ejects a floppy disk",
                  &RetroShell::exec <Token::drive, Token::eject>);
@@ -309,6 +372,10 @@ Interpreter::registerInstructions()
              "key", "Sets the emulation speed",
              &RetroShell::exec <Token::vicii, Token::set, Token::speed>, 1);
 
+    root.add({"vicii", "set", "rgba"},
+             "key", "Enables or disables the RGBA texture output",
+             &RetroShell::exec <Token::vicii, Token::set, Token::rgba>, 1);
+
     root.add({"vicii", "set", "graydotbug"},
              "key", "Enables or disables the gray dot bug",
              &RetroShell::exec <Token::vicii, Token::set, Token::graydotbug>, 1);
@@ -283,6 +283,71 @@ RetroShell::exec <Token::memory, Token::inspect> (Arguments& argv, long param)
 }
 
 
+//
+// Rewind buffer
+//
+
+template <> void
+RetroShell::exec <Token::rewind, Token::config> (Arguments& argv, long param)
+{
+    dump(c64.rewindBuffer, dump::Config);
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::set, Token::interval> (Arguments& argv, long param)
+{
+    c64.configure(OPT_REWIND_INTERVAL, util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::set, Token::budget> (Arguments& argv, long param)
+{
+    c64.configure(OPT_REWIND_BUDGET, util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::to> (Arguments& argv, long param)
+{
+    c64.rewindTo(util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::back> (Arguments& argv, long param)
+{
+    auto seconds = util::parseNum(argv.front());
+    c64.rewindTo(cpu.cycle - seconds * vic.getFrequency());
+}
+
+template <> void
+RetroShell::exec <Token::rewind, Token::inspect> (Arguments& argv, long param)
+{
+    dump(c64.rewindBuffer, dump::State);
+}
+
+
+//
+// Profiler
+//
+
+template <> void
+RetroShell::exec <Token::profiler, Token::inspect> (Arguments& argv, long param)
+{
+    dump(c64.profiler, dump::State);
+}
+
+template <> void
+RetroShell::exec <Token::profiler, Token::clear> (Arguments& argv, long param)
+{
+    c64.profiler.clear();
+}
+
+template <> void
+RetroShell::exec <Token::profiler, Token::save> (Arguments& argv, long param)
+{
+    c64.profiler.exportStats(argv.front());
+}
+
+
 //
 // Drive
 //
@@ -308,6 +373,13 @@ RetroShell::exec <Token::drive, Token::disconnect> (Arguments& argv, long param)
     c64.configure(OPT_DRV_CONNECT, id, false);
 }
 
+template <> void
+RetroShell::exec <Token::drive, Token::set, Token::accelerate> (Arguments& argv, long param)
+{
+    auto id = param ? DRIVE9 : DRIVE8;
+    c64.configure(OPT_DRV_ACCELERATE, id, util::parseBool(argv.front()));
+}
+
 template <> void
 RetroShell::exec <Token::drive, Token::eject> (Arguments& argv, long param)
 {
@@ -476,6 +548,12 @@ RetroShell::exec <Token::vicii, Token::set, Token::speed> (Arguments &argv, long
     c64.configure(OPT_VIC_SPEED, util::parseEnum <VICIISpeedEnum> (argv.front()));
 }
 
+template <> void
+RetroShell::exec <Token::vicii, Token::set, Token::rgba> (Arguments &argv, long param)
+{
+    c64.configure(OPT_VIC_RGBA_OUTPUT, util::parseBool(argv.front()));
+}
+
 template <> void
 RetroShell::exec <Token::vicii, Token::set, Token::graydotbug> (Arguments &argv, long param)
 {
@@ -0,0 +1,133 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "AudioSink.h"
+#include <cmath>
+#include <cstring>
+
+static void write16(u8 *&p, u16 value) { *p++ = LO_BYTE(value); *p++ = HI_BYTE(value); }
+static void write32(u8 *&p, u32 value) { write16(p, LO_WORD(value)); write16(p, HI_WORD(value)); }
+
+//
+// RawAudioSink
+//
+
+RawAudioSink::RawAudioSink(const string &path)
+{
+    stream.open(path, std::ios::binary);
+    if (!stream.is_open()) throw VC64Error(ERROR_FILE_CANT_CREATE, path);
+}
+
+void
+RawAudioSink::write(const SamplePair *samples, isize count)
+{
+    u8 buffer[8 * 512];
+
+    if (failed) return;
+
+    while (count > 0) {
+
+        isize chunk = std::min(count, (isize)512);
+        u8 *p = buffer;
+
+        for (isize i = 0; i < chunk; i++) {
+
+            u32 l, r;
+            std::memcpy(&l, &samples[i].left, 4);
+            std::memcpy(&r, &samples[i].right, 4);
+            write32(p, l);
+            write32(p, r);
+        }
+        stream.write((const char *)buffer, p - buffer);
+        if (!stream) { failed = true; return; }
+
+        samples += chunk;
+        count -= chunk;
+    }
+}
+
+
+//
+// WAVAudioSink
+//
+
+WAVAudioSink::WAVAudioSink(const string &path, double sampleRate) :
+sampleRate((u32)std::lround(sampleRate))
+{
+    stream.open(path, std::ios::binary);
+    if (!stream.is_open()) throw VC64Error(ERROR_FILE_CANT_CREATE, path);
+
+    // Write a preliminary header (the sizes are filled in later)
+    writeHeader();
+}
+
+WAVAudioSink::~WAVAudioSink()
+{
+    stream.seekp(0);
+    writeHeader();
+}
+
+void
+WAVAudioSink::write(const SamplePair *samples, isize count)
+{
+    u8 buffer[4 * 512];
+
+    if (failed) return;
+
+    auto convert = [](float value) {
+        return (u16)(i16)std::lround(std::fmax(-1.0f, std::fmin(1.0f, value)) * 32767.0f);
+    };
+
+    while (count > 0) {
+
+        isize chunk = std::min(count, (isize)512);
+        u8 *p = buffer;
+
+        for (isize i = 0; i < chunk; i++) {
+
+            write16(p, convert(samples[i].left));
+            write16(p, convert(samples[i].right));
+        }
+        stream.write((const char *)buffer, p - buffer);
+        if (!stream) { failed = true; return; }
+        this->count += (u32)chunk;
+
+        samples += chunk;
+        count -= chunk;
+    }
+}
+
+void
+WAVAudioSink::writeHeader()
+{
+    u8 header[44];
+    u8 *p = header;
+    u32 dataSize = count * 4;
+
+    auto tag = [&](const char *id) { std::memcpy(p, id, 4); p += 4; };
+
+    tag("RIFF");
+    write32(p, 36 + dataSize);
+    tag("WAVE");
+
+    tag("fmt ");
+    write32(p, 16);             // Size of the format chunk
+    write16(p, 1);              // PCM
+    write16(p, 2);              // Channels
+    write32(p, sampleRate);     // Sample rate
+    write32(p, sampleRate * 4); // Byte rate
+    write16(p, 4);              // Block alignment
+    write16(p, 16);             // Bits per sample
+
+    tag("data");
+    write32(p, dataSize);
+
+    stream.write((const char *)header, sizeof(header));
+}
@@ -0,0 +1,79 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "SIDStreams.h"
+#include "Error.h"
+#include <fstream>
+
+/* An audio sink receives the final stereo stream in offline rendering mode
+ * (see Muxer::setSink()). Unlike the ring buffer which is drained by the host
+ * in real time, a sink is fed with every produced sample. Samples are handed
+ * over in chunks from within the thread that runs the SID engines. Because
+ * nothing can catch an exception in there, write errors are latched and
+ * reported by the owner of the sink once recording has stopped.
+ */
+class AudioSink {
+
+protected:
+
+    // Set when a write operation failed (all further samples are dropped)
+    bool failed = false;
+
+public:
+
+    virtual ~AudioSink() = default;
+
+    // Consumes a chunk of samples (must not throw)
+    virtual void write(const SamplePair *samples, isize count) = 0;
+
+    // Checks whether some samples couldn't be written
+    bool hasFailed() const { return failed; }
+};
+
+/* Writes the stream into a file as interleaved 32-bit floating point values
+ * (little endian, left channel first).
+ */
+class RawAudioSink : public AudioSink {
+
+    std::ofstream stream;
+
+public:
+
+    RawAudioSink(const string &path) throws;
+
+    void write(const SamplePair *samples, isize count) override;
+};
+
+/* Writes the stream into a WAV file with 16-bit PCM samples. The header is
+ * finalized when the sink is deleted.
+ */
+class WAVAudioSink : public AudioSink {
+
+    std::ofstream stream;
+
+    // Sample rate recorded in the header
+    u32 sampleRate;
+
+    // Number of written sample pairs
+    u32 count = 0;
+
+public:
+
+    WAVAudioSink(const string &path, double sampleRate) throws;
+    ~WAVAudioSink();
+
+    void write(const SamplePair *samples, isize count) override;
+
+private:
+
+    // Writes the file header
+    void writeHeader();
+};
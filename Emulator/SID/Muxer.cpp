@@ -35,6 +35,19 @@ Muxer::Muxer(C64 &ref) : SubComponent(ref)
     }    
 }
 
+Muxer::~Muxer()
+{
+    // Terminate the synthesis thread
+    if (worker.joinable()) {
+
+        {   std::lock_guard<std::mutex> lock(workerMutex);
+            workerExit = true;
+        }
+        workerCond.notify_one();
+        worker.join();
+    }
+}
+
 void
 Muxer::_reset(bool hard)
 {
@@ -50,10 +63,7 @@ Muxer::clear()
     debug(AUDBUF_DEBUG, "clear()\n");
     
     // Wipe out the ringbuffer
-    stream.lock();
     stream.wipeOut();
-    stream.alignWritePtr();
-    stream.unlock();
 }
 
 SIDConfig
@@ -71,6 +81,7 @@ Muxer::getDefaultConfig()
     defaults.filter = true;
     defaults.engine = SIDENGINE_RESID;
     defaults.sampling = SAMPLING_INTERPOLATE;
+    defaults.async = false;
     defaults.volL = 50;
     defaults.volR = 50;
     
@@ -91,6 +102,7 @@ Muxer::resetConfig()
     setConfigItem(OPT_SID_FILTER, defaults.filter);
     setConfigItem(OPT_SID_ENGINE, defaults.engine);
     setConfigItem(OPT_SID_SAMPLING, defaults.sampling);
+    setConfigItem(OPT_SID_ASYNC, defaults.async);
     setConfigItem(OPT_AUDVOLL, defaults.volL);
     setConfigItem(OPT_AUDVOLR, defaults.volR);
 
@@ -123,6 +135,9 @@ Muxer::getConfigItem(Option option) const
         case OPT_SID_SAMPLING:
             return config.sampling;
             
+        case OPT_SID_ASYNC:
+            return config.async;
+            
         case OPT_AUDVOLL:
             return config.volL;
 
@@ -225,10 +240,18 @@ Muxer::setConfigItem(Option option, i64 value)
             }
             return;
             
+        case OPT_SID_ASYNC:
+            
+            suspended { config.async = value; }
+            return;
+            
         case OPT_AUDVOLL:
             
-            config.volL = std::clamp(value, 0LL, 100LL);
-            volL.set(powf((float)config.volL / 50, 1.4f));
+            suspended {
+                
+                config.volL = std::clamp(value, 0LL, 100LL);
+                volL.set(powf((float)config.volL / 50, 1.4f));
+            }
             
             if (wasMuted != isMuted()) {
                 msgQueue.put(isMuted() ? MSG_MUTE_ON : MSG_MUTE_OFF);
@@ -237,8 +260,11 @@ Muxer::setConfigItem(Option option, i64 value)
             
         case OPT_AUDVOLR:
 
-            config.volR = std::clamp(value, 0LL, 100LL);
-            volR.set(powf((float)config.volR / 50, 1.4f));
+            suspended {
+                
+                config.volR = std::clamp(value, 0LL, 100LL);
+                volR.set(powf((float)config.volR / 50, 1.4f));
+            }
 
             if (wasMuted != isMuted()) {
                 msgQueue.put(isMuted() ? MSG_MUTE_ON : MSG_MUTE_OFF);
@@ -407,10 +433,35 @@ Muxer::setSampleRate(double rate)
     }    
 }
 
+isize
+Muxer::willLoadFromBuffer(const u8 *buffer)
+{
+    // Make sure the synthesis thread doesn't touch the SID engines
+    drainWorker();
+    return 0;
+}
+
 isize
 Muxer::didLoadFromBuffer(const u8 *buffer)
 {
     for (isize i = 0; i < 4; i++) sidStream[i].clear(0);
+
+    // Let the shadow SIDs take over the restored chip state
+    if (workerActive) {
+        for (isize i = 0; i < 4; i++) shadow[i].sync(resid[i], fastsid[i], cycles);
+    }
+    return 0;
+}
+
+isize
+Muxer::willSaveToBuffer(const u8 *buffer)
+{
+    /* Snapshots are also taken while the emulator is running (rewind buffer,
+     * auto snapshots). Let the synthesis thread catch up before the state of
+     * the SID engines is serialized. It stays idle until the emulator thread
+     * records the next event.
+     */
+    drainWorker();
     return 0;
 }
 
@@ -422,11 +473,14 @@ Muxer::_run()
         clear();
     }
     rampUp();
+    
+    if (config.async) activateWorker();
 }
 
 void
 Muxer::_pause()
 {
+    deactivateWorker();
     rampDown();
 }
 
@@ -437,12 +491,14 @@ Muxer::_warpOn()
      * sync. To cope with it, we ramp down the volume when warping is switched
      * on and fade in smoothly when it is switched off.
      */
+    drainWorker();
     rampDown();
 }
 
 void
 Muxer::_warpOff()
 {
+    drainWorker();
     rampUp();
     clear();
 }
@@ -472,6 +528,8 @@ Muxer::_dump(dump::Category category, std::ostream& os) const
         os << SIDEngineEnum::key(config.engine) << std::endl;
         os << tab("Sampling");
         os << SamplingMethodEnum::key(config.sampling) << std::endl;
+        os << tab("Synthesis");
+        os << bol(config.async, "asynchronous", "synchronous") << std::endl;
         os << tab("Volume 1");
         os << config.vol[0] << std::endl;
         os << tab("Volume 2");
@@ -540,6 +598,8 @@ SIDStats
 Muxer::getStats()
 {
     stats.fillLevel = stream.fillLevel();
+    stats.bufferUnderflows = stream.underflows;
+    stats.bufferOverflows = stream.overflows;
     return stats;
 }
 
@@ -547,6 +607,8 @@ void
 Muxer::clearStats()
 {
     memset(&stats, 0, sizeof(stats));
+    stream.underflows = 0;
+    stream.overflows = 0;
 }
 
 SIDInfo
@@ -651,8 +713,9 @@ Muxer::mappedSID(u16 addr) const
 u8 
 Muxer::peek(u16 addr)
 {
-    // Get SIDs up to date
-    executeUntil(cpu.cycle);
+    // Get SIDs up to date (unless the synthesis thread is in charge)
+    bool async = workerActive && !c64.inFastForwardMode();
+    if (!async) executeUntil(cpu.cycle);
  
     // Select the target SID
     isize sidNr = config.enabled > 1 ? mappedSID(addr) : 0;
@@ -675,6 +738,13 @@ Muxer::peek(u16 addr)
         }
     }
     
+    // Let the shadow SID answer if the SID engines are busy elsewhere
+    if (async) {
+        
+        if (config.engine == SIDENGINE_RESID) shadow[sidNr].executeUntil(cpu.cycle);
+        return shadow[sidNr].peek(addr, config.engine);
+    }
+    
     switch (config.engine) {
             
         case SIDENGINE_FASTSID: return fastsid[sidNr].peek(addr);
@@ -732,12 +802,24 @@ Muxer::poke(u16 addr, u8 value)
 {
     trace(SIDREG_DEBUG, "poke(%x,%x)\n", addr, value);
     
-    // Get SID up to date
-    executeUntil(cpu.cycle);
- 
     // Select the target SID
     isize sidNr = config.enabled > 1 ? mappedSID(addr) : 0;
 
+    // Hand the write over to the synthesis thread if it is active
+    if (workerActive && !c64.inFastForwardMode()) {
+        
+        addr &= 0x1F;
+        
+        if (config.engine == SIDENGINE_RESID) shadow[sidNr].executeUntil(cpu.cycle);
+        shadow[sidNr].poke(addr, value);
+        
+        record(SIDEvent { (Cycle)cpu.cycle, (i8)sidNr, (u8)addr, value });
+        return;
+    }
+    
+    // Get SID up to date
+    executeUntil(cpu.cycle);
+ 
     addr &= 0x1F;
     
     // Keep both SID implementations up to date
@@ -747,11 +829,51 @@ Muxer::poke(u16 addr, u8 value)
 
 void
 Muxer::executeUntil(Cycle targetCycle)
+{
+    if (workerActive) {
+        
+        // Let the synthesis thread do the work
+        if (!c64.inFastForwardMode()) {
+            
+            record(SIDEvent { targetCycle, -1, 0, 0 });
+            return;
+        }
+        
+        // Fast-forward mode bypasses the synthesis thread
+        deactivateWorker();
+    }
+    
+    assert(targetCycle >= cycles);
+    
+    // Skip sample synthesis in fast-forward mode (unless rendering offline)
+    if (c64.inFastForwardMode() && !sink) {
+        
+        // Keep the chip state up to date (OSC3 and ENV3 are readable)
+        if (config.engine == SIDENGINE_RESID) {
+            
+            auto slot = CYCLE_PROFILER ? c64.profiler.enter(PROF_SID) : PROF_SID;
+            for (isize i = 0; i < 4; i++) {
+                if (isEnabled(i)) resid[i].clock(targetCycle - cycles);
+            }
+            if (CYCLE_PROFILER) c64.profiler.enter(slot);
+        }
+        
+        cycles = targetCycle;
+        return;
+    }
+    
+    auto slot = CYCLE_PROFILER ? c64.profiler.enter(PROF_SID) : PROF_SID;
+    synthesize(targetCycle);
+    if (CYCLE_PROFILER) c64.profiler.enter(slot);
+}
+
+void
+Muxer::synthesize(Cycle targetCycle)
 {
     assert(targetCycle >= cycles);
     
-    // Skip sample synthesis in power-safe mode
-    if (volL.current == 0 && volR.current == 0 && config.powerSave) {
+    // Skip sample synthesis in power-safe mode (unless rendering offline)
+    if (volL.current == 0 && volR.current == 0 && config.powerSave && !sink) {
     
         /* https://sourceforge.net/p/vice-emu/bugs/1374/
          *
@@ -788,42 +910,27 @@ Muxer::executeCycles(isize numCycles)
         debug(SID_EXEC, "Running SIDs for an extra cycle\n");
     }
     
-    switch (config.engine) {
-            
-        case SIDENGINE_FASTSID:
+    if (config.enabled > 1) {
 
-            // Run the primary SID (which is always enabled)
-            numSamples = fastsid[0].executeCycles(numCycles, sidStream[0]);
-            
-            // Run all other SIDS (if any)
-            if (config.enabled > 1) {
-                for (isize i = 1; i < 4; i++) {
-                    if (isEnabled(i)) {
-                        isize numSamples2 = fastsid[i].executeCycles(numCycles, sidStream[i]);
-                        numSamples = std::min(numSamples, numSamples2);
-                    }
-                }
-            }
-            break;
+        numSamples = executeMultiSID(numCycles);
 
-        case SIDENGINE_RESID:
+    } else {
 
-            // Run the primary SID (which is always enabled)
-            numSamples = resid[0].executeCycles(numCycles, sidStream[0]);
-            
-            // Run all other SIDS (if any)
-            if (config.enabled > 1) {
-                for (isize i = 1; i < 4; i++) {
-                    if (isEnabled(i)) {
-                        isize numSamples2 = resid[i].executeCycles(numCycles, sidStream[i]);
-                        numSamples = std::min(numSamples, numSamples2);
-                    }
-                }
-            }
-            break;
+        switch (config.engine) {
 
-        default:
-            fatalError;
+            case SIDENGINE_FASTSID:
+
+                numSamples = fastsid[0].executeCycles(numCycles, sidStream[0]);
+                break;
+
+            case SIDENGINE_RESID:
+
+                numSamples = resid[0].executeCycles(numCycles, sidStream[0]);
+                break;
+
+            default:
+                fatalError;
+        }
     }
     
     // Produce the final stereo stream
@@ -832,15 +939,69 @@ Muxer::executeCycles(isize numCycles)
     return numCycles;
 }
 
+isize
+Muxer::executeMultiSID(isize numCycles)
+{
+    isize numSamples[4] = { };
+    isize sids[4], count = 0;
+
+    for (isize i = 0; i < 4; i++) if (isEnabled(i)) sids[count++] = i;
+
+    auto run = [&](isize j) {
+
+        isize nr = sids[j];
+
+        switch (config.engine) {
+
+            case SIDENGINE_FASTSID:
+
+                numSamples[nr] = fastsid[nr].executeCycles(numCycles, sidStream[nr]);
+                break;
+
+            case SIDENGINE_RESID:
+
+                numSamples[nr] = resid[nr].executeCycles(numCycles, sidStream[nr]);
+                break;
+
+            default:
+                fatalError;
+        }
+    };
+
+    /* Each SID engine writes into its own stream. Hence, the engines can be
+     * run concurrently without affecting the result. The pool returns after
+     * all engines have finished which is when mixing can start. The pool is
+     * shared by all emulator instances to keep the number of threads bounded.
+     */
+    if (multiCore && numCycles >= parallelThreshold) {
+
+        util::WorkerPool::shared().run(count, run);
+
+    } else {
+
+        for (isize j = 0; j < count; j++) run(j);
+    }
+
+    isize result = numSamples[sids[0]];
+    for (isize j = 1; j < count; j++) result = std::min(result, numSamples[sids[j]]);
+
+    return result;
+}
+
 void
 Muxer::mixSingleSID(isize numSamples)
 {    
-    stream.lock();
-    
-    // Check for buffer overflow
-    if (stream.free() < numSamples) {
-        handleBufferOverflow();
+    // Check for buffer underflows and overflows (unless rendering offline)
+    if (!sink) {
+
+        if (stream.underflowOccurred()) {
+            handleBufferUnderflow();
+        }
+        if (stream.free() < numSamples) {
+            handleBufferOverflow();
+        }
     }
+    isize space = stream.free();
     
     debug(SID_EXEC, "vol0: %f pan0: %f volL: %f volR: %f\n",
           vol[0], pan[0], volL.current, volR.current);
@@ -863,20 +1024,30 @@ Muxer::mixSingleSID(isize numSamples)
         assert(abs(l) < 1.0);
         assert(abs(r) < 1.0);
         
-        stream.write(SamplePair { l, r } );
+        // Feed the sink or drop the sample if the consumer is lagging behind
+        if (sink) {
+            writeToSink(SamplePair { l, r } );
+        } else if (i < space) {
+            stream.write(SamplePair { l, r } );
+        }
     }
-    stream.unlock();
+    if (sink) flushSink();
 }
         
 void
 Muxer::mixMultiSID(isize numSamples)
 {
-    stream.lock();
-    
-    // Check for buffer overflow
-    if (stream.free() < numSamples) {
-        handleBufferOverflow();
+    // Check for buffer underflows and overflows (unless rendering offline)
+    if (!sink) {
+
+        if (stream.underflowOccurred()) {
+            handleBufferUnderflow();
+        }
+        if (stream.free() < numSamples) {
+            handleBufferOverflow();
+        }
     }
+    isize space = stream.free();
     
     debug(SID_EXEC, "vol0: %f pan0: %f volL: %f volR: %f\n",
           vol[0], pan[0], volL.current, volR.current);
@@ -909,9 +1080,127 @@ Muxer::mixMultiSID(isize numSamples)
         assert(abs(l) < 1.0);
         assert(abs(r) < 1.0);
         
-        stream.write(SamplePair { l, r } );
+        // Feed the sink or drop the sample if the consumer is lagging behind
+        if (sink) {
+            writeToSink(SamplePair { l, r } );
+        } else if (i < space) {
+            stream.write(SamplePair { l, r } );
+        }
+    }
+    if (sink) flushSink();
+}
+
+void
+Muxer::setSink(AudioSink *sink)
+{
+    suspended {
+
+        flushSink();
+        this->sink = sink;
+    }
+}
+
+void
+Muxer::flushSink()
+{
+    if (sinkCount) {
+
+        sink->write(sinkBuffer, sinkCount);
+        sinkCount = 0;
+    }
+}
+
+void
+Muxer::activateWorker()
+{
+    if (workerActive) return;
+    
+    debug(SID_EXEC, "Activating the synthesis thread\n");
+    
+    // Initialize the shadow SIDs with the current chip state
+    for (isize i = 0; i < 4; i++) {
+        shadow[i].sync(resid[i], fastsid[i], cycles);
+    }
+    
+    // Launch the synthesis thread if it isn't running yet
+    if (!worker.joinable()) worker = std::thread(&Muxer::workerMain, this);
+    
+    workerActive = true;
+}
+
+void
+Muxer::deactivateWorker()
+{
+    if (!workerActive) return;
+    
+    debug(SID_EXEC, "Deactivating the synthesis thread\n");
+    
+    drainWorker();
+    workerActive = false;
+}
+
+void
+Muxer::drainWorker()
+{
+    if (!workerActive) return;
+    
+    wakeUpWorker();
+    while (!eventLog.isEmpty()) std::this_thread::yield();
+}
+
+void
+Muxer::record(const SIDEvent &event)
+{
+    // If the log is full, wait for the synthesis thread to catch up
+    while (eventLog.isFull()) {
+        
+        wakeUpWorker();
+        std::this_thread::yield();
+    }
+    
+    eventLog.write(event);
+    
+    // Wake up the synthesis thread at synchronization points
+    if (event.sid < 0) wakeUpWorker();
+}
+
+void
+Muxer::wakeUpWorker()
+{
+    /* Acquiring the mutex guarantees that the notification doesn't get lost
+     * if the synthesis thread is about to fall asleep.
+     */
+    {   std::lock_guard<std::mutex> lock(workerMutex); }
+    workerCond.notify_one();
+}
+
+void
+Muxer::workerMain()
+{
+    while (true) {
+        
+        // Wait for something to do
+        {   std::unique_lock<std::mutex> lock(workerMutex);
+            workerCond.wait(lock, [this]() { return workerExit || !eventLog.isEmpty(); });
+            if (workerExit && eventLog.isEmpty()) return;
+        }
+        
+        // Replay all recorded events
+        while (!eventLog.isEmpty()) {
+            
+            auto &event = eventLog.current();
+            
+            synthesize(event.cycle);
+            
+            if (event.sid >= 0) {
+                
+                resid[event.sid].poke(event.addr, event.value);
+                fastsid[event.sid].poke(event.addr, event.value);
+            }
+            
+            eventLog.next();
+        }
     }
-    stream.unlock();
 }
 
 void
@@ -942,9 +1231,9 @@ Muxer::handleBufferUnderflow()
     // (1) The consumer runs slightly faster than the producer.
     // (2) The producer is halted or not startet yet.
     
-    trace(AUDBUF_DEBUG, "BUFFER UNDERFLOW (r: %zd w: %zd)\n", stream.r, stream.w);
+    trace(AUDBUF_DEBUG, "BUFFER UNDERFLOW (r: %zd w: %zd)\n", stream.r.load(), stream.w.load());
 
-    // Reset the write pointer
+    // Fill up the ring buffer with silence
     stream.alignWritePtr();
     
     // Determine the elapsed seconds since the last pointer adjustment
@@ -953,8 +1242,6 @@ Muxer::handleBufferUnderflow()
     
     // Adjust the sample rate, if condition (1) holds
     if (elapsedTime.asSeconds() > 10.0) {
-
-        stats.bufferUnderflows++;
         
         // Increase the sample rate based on what we've measured
         isize offPerSecond = (isize)(stream.count() / elapsedTime.asSeconds());
@@ -970,10 +1257,11 @@ Muxer::handleBufferOverflow()
     // (1) The consumer runs slightly slower than the producer
     // (2) The consumer is halted or not startet yet
     
-    trace(AUDBUF_DEBUG, "BUFFER OVERFLOW (r: %zd w: %zd)\n", stream.r, stream.w);
-    
-    // Reset the write pointer
-    stream.alignWritePtr();
+    // Ask the consumer to drop samples unless a request is pending already
+    if (!stream.requestTrim()) return;
+
+    trace(AUDBUF_DEBUG, "BUFFER OVERFLOW (r: %zd w: %zd)\n", stream.r.load(), stream.w.load());
+    stream.overflows++;
     
     // Determine the number of elapsed seconds since the last adjustment
     auto elapsedTime = util::Time::now() - lastAlignment;
@@ -983,8 +1271,6 @@ Muxer::handleBufferOverflow()
     // Adjust the sample rate, if condition (1) holds
     if (elapsedTime.asSeconds() > 10.0) {
         
-        stats.bufferOverflows++;
-        
         // Decrease the sample rate based on what we've measured
         isize offPerSecond = (isize)(stream.count() / elapsedTime.asSeconds());
         double newSampleRate = getSampleRate() - offPerSecond;
@@ -1005,18 +1291,14 @@ Muxer::copyMono(float *target, isize n)
 {
     if (recorder.isRecording()) {
         for (isize i = 0; i < n; i++) target[i] = 0.0;
+        
+        // Drop the samples the recorder has processed
+        stream.processRequests();
         return;
     }
     
-    stream.lock();
-    
-    // Check for a buffer underflow
-    if (stream.count() < n) handleBufferUnderflow();
-
     // Copy sound samples
     stream.copyMono(target, n, volL, volR);
-    
-    stream.unlock();
 }
 
 void
@@ -1024,18 +1306,14 @@ Muxer::copyStereo(float *target1, float *target2, isize n)
 {
     if (recorder.isRecording()) {
         for (isize i = 0; i < n; i++) target1[i] = target2[i] = 0.0;
+        
+        // Drop the samples the recorder has processed
+        stream.processRequests();
         return;
     }
 
-    stream.lock();
-    
-    // Check for a buffer underflow
-    if (stream.count() < n) handleBufferUnderflow();
-
     // Copy sound samples
     stream.copyStereo(target1, target2, n, volL, volR);
-    
-    stream.unlock();
 }
 
 void
@@ -1043,16 +1321,12 @@ Muxer::copyInterleaved(float *target, isize n)
 {
     if (recorder.isRecording()) {
         for (isize i = 0; i < n; i++) target[i] = 0.0;
+        
+        // Drop the samples the recorder has processed
+        stream.processRequests();
         return;
     }
 
-    stream.lock();
-    
-    // Check for a buffer underflow
-    if (stream.count() < n) handleBufferUnderflow();
-
     // Read sound samples
     stream.copyInterleaved(target, n, volL, volR);
-    
-    stream.unlock();
 }
@@ -16,7 +16,10 @@
 #include "SIDStreams.h"
 #include "FastSID.h"
 #include "ReSID.h"
+#include "ShadowSID.h"
+#include "AudioSink.h"
 #include "Chrono.h"
+#include <condition_variable>
 
 /* Architecture of the audio pipeline
  *
@@ -38,6 +41,22 @@
  *   SID 3 --->| Buffer |----->                               |
  *          |   --------                                      |
  *           -------------------------------------------------
+ *
+ * Sound samples are either synthesized synchronously or asynchronously. In
+ * synchronous mode, the emulator thread runs the SID engines whenever a SID
+ * register is accessed and at the end of each frame. In asynchronous mode
+ * (OPT_SID_ASYNC), the emulator thread only records register writes in a
+ * lock-free event log. The log is replayed by a separate synthesis thread
+ * which runs the SID engines and mixes the final stereo stream. Register
+ * reads are answered by shadow SIDs which are kept up to date by the emulator
+ * thread. The synthesis thread is only active while the emulator is running
+ * and not in fast-forward mode.
+ *
+ * In offline rendering mode, the final stereo stream is written into an
+ * AudioSink instead of the ring buffer. No samples are dropped in this mode,
+ * because the sink is fed directly. Furthermore, samples are synthesized in
+ * fast-forward mode, too. Hence, calling C64::fastForward() renders the audio
+ * output as fast as possible while VICII runs headless.
  */
 
 class Muxer : public SubComponent {
@@ -94,7 +113,54 @@ private:
 
     // Panning factors
     float pan[4] = { 0, 0, 0, 0 };
-        
+
+
+    //
+    // Asynchronous synthesis
+    //
+
+    // Shadow SIDs answering register reads
+    ShadowSID shadow[4];
+
+    // Register writes and synchronization points to be processed
+    SIDEventLog eventLog;
+
+    // The synthesis thread (launched on first use)
+    std::thread worker;
+    std::mutex workerMutex;
+    std::condition_variable workerCond;
+    bool workerExit = false;
+
+    // Indicates whether the SID engines are owned by the synthesis thread
+    bool workerActive = false;
+
+
+    //
+    // Parallel synthesis
+    //
+
+    /* Minimum number of cycles to emulate in one chunk before the SID engines
+     * are run concurrently. Handing over smaller chunks to the worker pool
+     * costs more than it gains.
+     */
+    static constexpr isize parallelThreshold = 1000;
+
+    // Indicates whether multiple SID engines can be run concurrently
+    bool multiCore = std::thread::hardware_concurrency() > 1;
+
+
+    //
+    // Offline rendering
+    //
+
+    // Receiver of the final stereo stream (nullptr = write into ring buffer)
+    AudioSink *sink = nullptr;
+
+    // Samples waiting to be handed over to the sink
+    static constexpr isize sinkCapacity = 512;
+    SamplePair sinkBuffer[sinkCapacity];
+    isize sinkCount = 0;
+
 public:
         
 
@@ -120,6 +186,7 @@ public:
 public:
 	
 	Muxer(C64 &ref);
+    ~Muxer();
 
     // Resets the output buffer
     void clear();
@@ -185,7 +252,9 @@ private:
     isize _size() override { COMPUTE_SNAPSHOT_SIZE }
     isize _load(const u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
     isize _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    isize willLoadFromBuffer(const u8 *buffer) override;
     isize didLoadFromBuffer(const u8 *buffer) override;
+    isize willSaveToBuffer(const u8 *buffer) override;
     
     
     //
@@ -271,13 +340,15 @@ public:
             
     /* Handles a buffer underflow condition. A buffer underflow occurs when the
      * audio device of the host machine needs sound samples than SID hasn't
-     * produced, yet.
+     * produced, yet. The condition is detected by the audio thread and
+     * handled by the emulator thread when the next samples are produced.
      */
     void handleBufferUnderflow();
     
     /* Handles a buffer overflow condition. A buffer overflow occurs when SID
      * is producing more samples than the audio device of the host machine is
-     * able to consume.
+     * able to consume. Samples that don't fit are dropped and the audio
+     * thread is asked to skip the oldest ones.
      */
     void handleBufferOverflow();
     
@@ -301,10 +372,64 @@ public:
 
 private:
     
+    // Produces the sound samples up to a certain cycle
+    void synthesize(Cycle targetCycle);
+
+    // Called by executeCycles to run the SID engines of multi-SID setups
+    isize executeMultiSID(isize numCycles);
+
     // Called by executeCycles to produce the final stereo stream
     void mixSingleSID(isize numSamples);
     void mixMultiSID(isize numSamples);
 
+
+    //
+    // Rendering offline
+    //
+
+public:
+
+    /* Redirects the final stereo stream into the provided sink. Passing
+     * nullptr switches back to the ring buffer. The sink is not owned by the
+     * muxer and must outlive its use.
+     */
+    void setSink(AudioSink *sink);
+    AudioSink *getSink() const { return sink; }
+
+private:
+
+    // Adds a sample pair to the sink buffer
+    void writeToSink(SamplePair pair) {
+        sinkBuffer[sinkCount++] = pair;
+        if (sinkCount == sinkCapacity) flushSink();
+    }
+
+    // Hands all buffered samples over to the sink
+    void flushSink();
+
+
+    //
+    // Synthesizing asynchronously
+    //
+
+private:
+
+    // Hands the SID engines over to the synthesis thread or takes them back
+    void activateWorker();
+    void deactivateWorker();
+
+    // Waits until the synthesis thread has processed all recorded events
+    void drainWorker();
+
+    // Records an event for the synthesis thread
+    void record(const SIDEvent &event);
+
+    // Wakes up the synthesis thread
+    void wakeUpWorker();
+
+    // Main function of the synthesis thread
+    void workerMain();
+
     
     //
     // Copying data from the ring buffer
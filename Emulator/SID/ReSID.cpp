@@ -300,3 +300,23 @@ ReSID::executeCycles(isize numCycles)
 {
     return executeCycles(numCycles, muxer.sidStream[nr]);
 }
+
+void
+ReSID::clock(isize numCycles)
+{
+    auto &voice = sid->voice;
+
+    /* Clock the chip cycle by cycle. reSID's multi-cycle variant skips the
+     * envelope pipeline which is visible through ENV3. The envelopes of
+     * voices 1 and 2 are invisible to the CPU, but they are cheap to clock.
+     * Keeping them up to date lets notes continue at the proper level when
+     * sound synthesis resumes.
+     */
+    for (isize i = 0; i < numCycles; i++) {
+
+        voice[0].envelope.clock();
+        voice[1].envelope.clock();
+        clockReadableState(*sid);
+    }
+}
+
@@ -30,6 +30,8 @@
 
 class ReSID : public SubComponent {
 
+    friend class ShadowSID;
+
     // Number of this SID (0 = primary SID)
     int nr;
 
@@ -191,4 +193,32 @@ public:
      */
     i64 executeCycles(isize numCycles, SampleStream &stream);
     i64 executeCycles(isize numCycles);
+    
+    /* Runs SID for the specified amount of CPU cycles without generating any
+     * sound samples. The oscillators and all envelope generators are updated.
+     * The filters are left alone.
+     */
+    void clock(isize numCycles);
+    
+    /* Emulates the CPU-visible part of a reSID instance for a single cycle.
+     * This function is shared with class ShadowSID.
+     */
+    static void clockReadableState(reSID::SID &sid) {
+        
+        auto &voice = sid.voice;
+        
+        // Only the envelope of voice 3 is visible (ENV3)
+        voice[2].envelope.clock();
+        
+        // All oscillators are clocked, because they can be synchronized
+        for (isize i = 0; i < 3; i++) voice[i].wave.clock();
+        for (isize i = 0; i < 3; i++) voice[i].wave.synchronize();
+        for (isize i = 0; i < 3; i++) voice[i].wave.set_waveform_output();
+        
+        // Perform pipelined writes (MOS8580)
+        if (sid.write_pipeline) sid.write();
+        
+        // Age the bus value
+        if (!--sid.bus_value_ttl) sid.bus_value = 0;
+    }
 };
@@ -13,84 +13,147 @@
 void
 StereoStream::alignWritePtr()
 {
-    this->align(this->cap() / 2);
+    for (isize i = count(); i < capacity / 2; i++) add(0, 0);
+}
+
+bool
+StereoStream::requestTrim()
+{
+    isize target = (w.load(std::memory_order_relaxed) + capacity - capacity / 2) % capacity;
+    isize none = -1;
+    
+    return skipRequest.compare_exchange_strong(none, target);
 }
 
 void
-StereoStream::copyMono(float *buffer, isize n, Volume &volL, Volume &volR)
-{    
-    // The caller has to ensure that no buffer underflows occurs
-    assert(count() >= n);
+StereoStream::wipeOut()
+{
+    // Make the consumer skip everything written so far
+    skipRequest = w.load(std::memory_order_relaxed);
+    
+    // Start over with silence
+    for (isize i = 0, n = std::min(free(), capacity / 2); i < n; i++) add(0, 0);
+}
+
+void
+StereoStream::processRequests()
+{
+    // Skip samples if requested by the producer
+    isize target = skipRequest.exchange(-1);
+    if (target >= 0) {
+        
+        // Never move backwards
+        isize oldr = r.load(std::memory_order_relaxed);
+        if ((capacity + target - oldr) % capacity <= count()) {
+            r.store(target, std::memory_order_release);
+        }
+    }
+}
+
+isize
+StereoStream::prepareCopy(isize n)
+{
+    processRequests();
+    
+    isize available = count();
+    if (available >= n) return n;
     
+    // Ask the producer to fill up the buffer
+    underflows++;
+    alignRequest = true;
+    return available;
+}
+
+void
+StereoStream::copyMono(float *buffer, isize n, Volume &volL, Volume &volR)
+{
+    isize cnt = prepareCopy(n);
+    isize pos = r.load(std::memory_order_relaxed);
+
     if (volL.isFading()) {
         
-        for (isize i = 0; i < n; i++, volL.shift()) {
+        for (isize i = 0; i < cnt; i++, volL.shift()) {
             
-            SamplePair pair = read();
+            SamplePair pair = elements[pos];
+            if (++pos == capacity) pos = 0;
             *buffer++ = (pair.left + pair.right) * volL.current;
         }
 
     } else {
         
-        for (isize i = 0; i < n; i++) {
+        for (isize i = 0; i < cnt; i++) {
                             
-            SamplePair pair = read();
+            SamplePair pair = elements[pos];
+            if (++pos == capacity) pos = 0;
             *buffer++ = (pair.left + pair.right) * volL.current;
         }
     }
+    r.store(pos, std::memory_order_release);
+
+    // Fill the rest with silence
+    for (isize i = cnt; i < n; i++) *buffer++ = 0.0;
 }
 
 void
 StereoStream::copyStereo(float *left, float *right, isize n, Volume &volL, Volume &volR)
 {
-    // The caller has to ensure that no buffer underflows occurs
-    assert(count() >= n);
+    isize cnt = prepareCopy(n);
+    isize pos = r.load(std::memory_order_relaxed);
 
-    // printf("isFading: %d\n", volume.isFading());
-    // printf("cur: %f target: %f delta: %f\n", volume.current, volume.target[0], volume.delta[0]);
-    
     if (volL.isFading() || volR.isFading()) {
                 
-        for (isize i = 0; i < n; i++, volL.shift(), volR.shift()) {
+        for (isize i = 0; i < cnt; i++, volL.shift(), volR.shift()) {
             
-            SamplePair pair = read();
+            SamplePair pair = elements[pos];
+            if (++pos == capacity) pos = 0;
             *left++ = pair.left * volL.current;
             *right++ = pair.right * volR.current;
         }
 
     } else {
         
-        for (isize i = 0; i < n; i++) {
+        for (isize i = 0; i < cnt; i++) {
                                         
-            SamplePair pair = read();
+            SamplePair pair = elements[pos];
+            if (++pos == capacity) pos = 0;
             *left++ = pair.left * volL.current;
             *right++ = pair.right * volR.current;
         }
     }
+    r.store(pos, std::memory_order_release);
+
+    // Fill the rest with silence
+    for (isize i = cnt; i < n; i++) *left++ = *right++ = 0.0;
 }
 
 void
 StereoStream::copyInterleaved(float *buffer, isize n, Volume &volL, Volume &volR)
 {
-    // The caller has to ensure that no buffer underflows occurs
-    assert(count() >= n);
+    isize cnt = prepareCopy(n);
+    isize pos = r.load(std::memory_order_relaxed);
 
     if (volL.isFading()) {
                 
-        for (isize i = 0; i < n; i++, volL.shift()) {
+        for (isize i = 0; i < cnt; i++, volL.shift()) {
             
-            SamplePair pair = read();
+            SamplePair pair = elements[pos];
+            if (++pos == capacity) pos = 0;
             *buffer++ = pair.left * volL.current;
             *buffer++ = pair.right * volR.current;
         }
 
     } else {
         
-        for (isize i = 0; i < n; i++) {
+        for (isize i = 0; i < cnt; i++) {
                                         
-            SamplePair pair = read();
+            SamplePair pair = elements[pos];
+            if (++pos == capacity) pos = 0;
             *buffer++ = pair.left * volL.current;
             *buffer++ = pair.right * volR.current;
         }
     }
+    r.store(pos, std::memory_order_release);
+
+    // Fill the rest with silence
+    for (isize i = 2 * cnt; i < 2 * n; i++) *buffer++ = 0.0;
 }
@@ -12,46 +12,208 @@
 #include "Concurrency.h"
 #include "RingBuffer.h"
 #include "Volume.h"
+#include <atomic>
 
 typedef util::RingBuffer<short, 2048> SampleStream;
 
 typedef struct { float left; float right; } SamplePair;
 
-class StereoStream : public util::RingBuffer < SamplePair, 12288 > {
+/* An entry of the SID event log. Each entry either describes a register write
+ * or a synchronization point. The latter marks the CPU cycle up to which
+ * sound samples are requested.
+ */
+typedef struct
+{
+    // CPU cycle in which the event occurred
+    Cycle cycle;
+
+    // Target SID (-1 for synchronization points)
+    i8 sid;
+
+    // Register number and written value
+    u8 addr;
+    u8 value;
+}
+SIDEvent;
+
+/* The SID event log. The log is a lock-free ring buffer connecting exactly
+ * one producer (the emulator thread recording SID register writes) with
+ * exactly one consumer (the synthesis thread replaying them). The consumer
+ * removes an event only after it has been processed. Hence, an empty log
+ * indicates that the consumer has caught up with the producer.
+ */
+class SIDEventLog {
+
+    // Number of elements (one element is kept free to separate r from w)
+    static constexpr isize capacity = 4096;
+
+    // Element storage
+    SIDEvent elements[capacity];
+
+    // Read and write pointers
+    std::atomic<isize> r = 0;
+    std::atomic<isize> w = 0;
+
+public:
+
+    bool isEmpty() const {
+        return r.load(std::memory_order_acquire) == w.load(std::memory_order_acquire);
+    }
+    bool isFull() const {
+        return (w.load(std::memory_order_relaxed) + 1) % capacity == r.load(std::memory_order_acquire);
+    }
+
+    // Appends an event (producer)
+    void write(const SIDEvent &event) {
+
+        isize oldw = w.load(std::memory_order_relaxed);
+        assert(((oldw + 1) % capacity) != r.load(std::memory_order_acquire));
+        elements[oldw] = event;
+        w.store((oldw + 1) % capacity, std::memory_order_release);
+    }
+
+    // Returns the oldest event (consumer)
+    const SIDEvent &current() const {
+        return elements[r.load(std::memory_order_relaxed)];
+    }
+
+    // Removes the oldest event (consumer)
+    void next() {
+        r.store((r.load(std::memory_order_relaxed) + 1) % capacity, std::memory_order_release);
+    }
+};
+
+/* The final stereo stream. The stream is a lock-free ring buffer connecting
+ * exactly one producer (the emulator thread mixing the SID output) with
+ * exactly one consumer (the audio thread of the host OS). The read pointer is
+ * only modified by the consumer and the write pointer only by the producer.
+ * Both pointers are published with release semantics, so neither side ever
+ * waits for the other. Buffer underflows and overflows are not repaired by
+ * the side detecting them. Instead, the detecting side posts a request which
+ * is processed by the side owning the affected pointer.
+ */
+class StereoStream {
+    
+    // Number of elements (one element is kept free to separate r from w)
+    static constexpr isize capacity = 12288;
+    
+    // Element storage
+    SamplePair elements[capacity];
     
-    // Mutex for synchronizing read / write accesses
-    util::ReentrantMutex mutex;
+public:
+    
+    // Read and write pointers
+    std::atomic<isize> r = 0;
+    std::atomic<isize> w = 0;
+
+    // Number of buffer underflows and overflows
+    std::atomic<u64> underflows = 0;
+    std::atomic<u64> overflows = 0;
 
+private:
+    
+    // Set by the consumer to request a realignment of the write pointer
+    std::atomic<bool> alignRequest = false;
+    
+    // Set by the producer to make the consumer skip all samples up to here
+    std::atomic<isize> skipRequest = -1;
 
+    
     //
-    // Synchronizing access
+    // Querying the fill status
     //
-
+    
 public:
 
-    // Locks or unlocks the mutex
-    void lock() { mutex.lock(); }
-    void unlock() { mutex.unlock(); }
+    isize cap() const { return capacity; }
+    isize count() const { return (capacity + w.load() - r.load()) % capacity; }
+    isize free() const { return capacity - count() - 1; }
+    double fillLevel() const { return (double)count() / capacity; }
+    bool isEmpty() const { return count() == 0; }
+    bool isFull() const { return free() == 0; }
+
+    // Reads a sample pair without moving the read pointer
+    const SamplePair& current(isize offset) const {
+        return elements[(r.load(std::memory_order_relaxed) + offset) % capacity];
+    }
 
-    // Initializes the ring buffer with zeroes
-    void wipeOut() { this->clear(SamplePair {0,0} ); }
+    
+    //
+    // Producing samples (emulator thread)
+    //
     
     // Adds a sample to the ring buffer
-    void add(float l, float r) { this->write(SamplePair {l,r} ); }
+    void write(SamplePair pair) {
         
-    // Puts the write pointer somewhat ahead of the read pointer
+        isize oldw = w.load(std::memory_order_relaxed);
+        assert(((oldw + 1) % capacity) != r.load(std::memory_order_acquire));
+        elements[oldw] = pair;
+        w.store((oldw + 1) % capacity, std::memory_order_release);
+    }
+    void add(float l, float r) { write(SamplePair {l,r} ); }
+    
+    // Checks whether the consumer has run out of data since the last call
+    bool underflowOccurred() { return alignRequest.exchange(false); }
+
+    // Fills up the ring buffer with silence until it is half full
     void alignWritePtr();
 
+    /* Requests the consumer to drop samples. The function is called when the
+     * ring buffer runs full. The consumer will skip all samples except the
+     * most recent ones up to a fill level of 50%. The function returns false
+     * if the consumer hasn't processed the previous request yet.
+     */
+    bool requestTrim();
+    
+    // Requests the consumer to drop all samples written so far
+    void wipeOut();
+
+    // Requests the consumer to drop all samples up to the given position
+    void requestSkip(isize target) { skipRequest = target % capacity; }
+
+    /* Provides read-only access to a written sample. The function is used by
+     * the screen recorder which taps the stream without consuming from it.
+     * Samples between the read and the write pointer stay valid until the
+     * consumer has moved beyond them.
+     */
+    const SamplePair& element(isize pos) const { return elements[pos % capacity]; }
+    
     
     //
-    // Copying data
+    // Consuming samples (audio thread)
     //
     
+    // Reads a sample from the ring buffer
+    SamplePair read() {
+        
+        isize oldr = r.load(std::memory_order_relaxed);
+        assert(oldr != w.load(std::memory_order_acquire));
+        SamplePair result = elements[oldr];
+        r.store((oldr + 1) % capacity, std::memory_order_release);
+        return result;
+    }
+    
+    // Drops all samples
+    void flush() { r.store(w.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Processes pending producer requests without copying samples
+    void processRequests();
+    
     /* Copies n audio samples into a memory buffer. These functions mark the
      * final step in the audio pipeline. They are used to copy the generated
-     * sound samples into the buffers of the native sound device.
+     * sound samples into the buffers of the native sound device. If the ring
+     * buffer contains less than n samples, the remaining space is filled with
+     * silence and the producer is asked to realign the write pointer.
      */
     void copyMono(float *buffer, isize n, Volume &volL, Volume &volR);
     void copyStereo(float *left, float *right, isize n, Volume &volL, Volume &volR);
     void copyInterleaved(float *buffer, isize n, Volume &volL, Volume &volR);
+    
+private:
+    
+    /* Prepares a copy operation. The function processes pending producer
+     * requests and returns the number of samples that can be copied. If less
+     * than n samples are available, a buffer underflow is reported.
+     */
+    isize prepareCopy(isize n);
 };
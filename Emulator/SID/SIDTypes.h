@@ -119,6 +119,7 @@ typedef struct
     // Emlation engine settings
     SIDEngine engine;
     SamplingMethod sampling;
+    bool async;
     
     // Master volume (left and right channel)
     i64 volL;
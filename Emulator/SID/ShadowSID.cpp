@@ -0,0 +1,89 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "ShadowSID.h"
+#include <cstdlib>
+
+ShadowSID::ShadowSID()
+{
+    sid = new reSID::SID();
+}
+
+ShadowSID::~ShadowSID()
+{
+    delete sid;
+}
+
+void
+ShadowSID::sync(const ReSID &resid, const FastSID &fastsid, Cycle cycle)
+{
+    const reSID::SID &src = *resid.sid;
+
+    sid->set_chip_model(src.sid_model);
+
+    // The sampling method affects how writes are pipelined on the MOS8580
+    sid->sampling = src.sampling;
+
+    /* Copy the voices. We don't utilize reSID's state API, because it misses
+     * some internal pipeline registers of the envelope generators.
+     */
+    for (isize i = 0; i < 3; i++) sid->voice[i] = src.voice[i];
+
+    // Copying the voices has overwritten the sync pointers
+    sid->voice[0].set_sync_source(&sid->voice[2]);
+    sid->voice[1].set_sync_source(&sid->voice[0]);
+    sid->voice[2].set_sync_source(&sid->voice[1]);
+
+    sid->bus_value = src.bus_value;
+    sid->bus_value_ttl = src.bus_value_ttl;
+    sid->write_pipeline = src.write_pipeline;
+    sid->write_address = src.write_address;
+
+    latchedDataBus = fastsid.latchedDataBus;
+    this->cycle = cycle;
+}
+
+void
+ShadowSID::executeUntil(Cycle targetCycle)
+{
+    for (; cycle < targetCycle; cycle++) ReSID::clockReadableState(*sid);
+}
+
+u8
+ShadowSID::peek(u16 addr, SIDEngine engine)
+{
+    switch (engine) {
+
+        case SIDENGINE_FASTSID:
+
+            switch (addr) {
+
+                case 0x19: case 0x1A: return 0xFF;
+                case 0x1B: case 0x1C: return (u8)rand();
+
+                default:
+                    return latchedDataBus;
+            }
+
+        case SIDENGINE_RESID:
+
+            return sid->read((reSID::reg8)addr);
+
+        default:
+            fatalError;
+    }
+}
+
+void
+ShadowSID::poke(u16 addr, u8 value)
+{
+    sid->write((reSID::reg8)addr, value);
+    latchedDataBus = value;
+}
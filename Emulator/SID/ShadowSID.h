@@ -0,0 +1,70 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "SIDTypes.h"
+#include "FastSID.h"
+#include "ReSID.h"
+
+/* This class answers SID register reads while the SID engines are running on
+ * the synthesis thread. It mimics the readable part of a SID, only. For
+ * reSID, this is the data bus and OSC3 and ENV3 which depend on the three
+ * oscillators and the envelope generator of voice 3. These units are clocked
+ * cycle by cycle whereas the expensive parts of reSID (filters, resampling)
+ * are skipped. FastSID returns random values for OSC3 and ENV3. Hence, only
+ * the latched data bus value needs to be tracked in this case.
+ */
+class ShadowSID {
+
+    // reSID instance providing the oscillators and envelope generators
+    reSID::SID *sid;
+
+    // CPU cycle up to which the shadow has been clocked
+    Cycle cycle = 0;
+
+    // Value of FastSID's data bus latch
+    u8 latchedDataBus = 0;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    ShadowSID();
+    ~ShadowSID();
+
+    // Takes over the state of the SID engines
+    void sync(const ReSID &resid, const FastSID &fastsid, Cycle cycle);
+
+
+    //
+    // Emulating
+    //
+
+public:
+
+    // Emulates the readable registers up to the specified cycle
+    void executeUntil(Cycle targetCycle);
+
+
+    //
+    // Accessing
+    //
+
+public:
+
+    // Reads a SID register the same way the selected engine would
+    u8 peek(u16 addr, SIDEngine engine);
+
+    // Writes a SID register
+    void poke(u16 addr, u8 value);
+};
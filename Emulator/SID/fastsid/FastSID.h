@@ -35,6 +35,8 @@
 
 class FastSID : public SubComponent {
 
+    friend class ShadowSID;
+
     // Number of this SID (0 = primary SID)
     int nr;
 
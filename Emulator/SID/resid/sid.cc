@@ -26,6 +26,19 @@
 
 #include "sid.h"
 #include <math.h>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RESID_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define RESID_NEON 1
+#include <arm_neon.h>
+#endif
 
 #ifndef round
 #define round(x) (x>=0.0?floor(x+0.5):ceil(x-0.5))
@@ -56,9 +69,7 @@ SID::SID()
   fir = 0;
   fir_N = 0;
   fir_RES = 0;
-  fir_beta = 0;
-  fir_f_cycles_per_sample = 0;
-  fir_filter_scale = 0;
+  set_convolution_kernel(best_convolution_kernel());
 
   sid_model = MOS6581;
   voice[0].set_sync_source(&voice[2]);
@@ -81,7 +92,6 @@ SID::SID()
 SID::~SID()
 {
   delete[] sample;
-  delete[] fir;
 }
 
 
@@ -475,6 +485,245 @@ void SID::enable_external_filter(bool enable)
 }
 
 
+// ----------------------------------------------------------------------------
+// FIR table cache.
+//
+// Computing the FIR tables is expensive and they can grow large in fast-mem
+// resampling mode. Since the tables only depend on the sampling parameters,
+// they are computed once and shared by all SID instances. The cache keeps
+// weak references, i.e., a table is freed as soon as the last SID instance
+// using it has switched to other parameters or has been deleted.
+// ----------------------------------------------------------------------------
+namespace
+{
+  struct fir_key
+  {
+    double clock_freq;
+    sampling_method method;
+    double sample_freq;
+    double pass_freq;
+    double filter_scale;
+
+    bool operator<(const fir_key& other) const
+    {
+      return std::tie(clock_freq, method, sample_freq, pass_freq, filter_scale) <
+        std::tie(other.clock_freq, other.method, other.sample_freq,
+                 other.pass_freq, other.filter_scale);
+    }
+  };
+
+  std::map<fir_key, std::weak_ptr<const short> >& fir_cache()
+  {
+    static std::map<fir_key, std::weak_ptr<const short> > cache;
+    return cache;
+  }
+}
+
+std::mutex& SID::fir_cache_mutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::weak_ptr<const short>& SID::fir_cache_lookup(double clock_freq,
+                                                  sampling_method method,
+                                                  double sample_freq,
+                                                  double pass_freq,
+                                                  double filter_scale)
+{
+  std::map<fir_key, std::weak_ptr<const short> >& cache = fir_cache();
+
+  // Remove the entries of all tables that are no longer in use.
+  for (auto it = cache.begin(); it != cache.end();) {
+    it = it->second.expired() ? cache.erase(it) : std::next(it);
+  }
+
+  fir_key key = { clock_freq, method, sample_freq, pass_freq, filter_scale };
+  return cache[key];
+}
+
+int SID::fir_cache_size()
+{
+  std::lock_guard<std::mutex> guard(fir_cache_mutex());
+
+  int count = 0;
+  for (auto& it : fir_cache()) {
+    if (!it.second.expired()) count++;
+  }
+  return count;
+}
+
+
+// ----------------------------------------------------------------------------
+// FIR convolution kernels.
+//
+// The convolution of the sample ring buffer with the FIR table dominates the
+// cost of resampling. Besides the scalar implementation, SIMD kernels are
+// provided which are selected at runtime depending on the host CPU. The SIMD
+// kernels multiply pairs of 16-bit values into 32-bit sums which wrap around
+// the same way as the scalar integer arithmetic. Hence, all kernels produce
+// bit-identical results.
+// ----------------------------------------------------------------------------
+static int convolve_scalar(const short* a, const short* b, int n)
+{
+  int out = 0;
+  for (int i = 0; i < n; i++) {
+    out += a[i]*b[i];
+  }
+  return out;
+}
+
+#if RESID_X86
+
+#ifdef __SSE2__
+static int convolve_sse2(const short* a, const short* b, int n)
+{
+  __m128i acc = _mm_setzero_si128();
+
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+  }
+
+  // Add up the four partial sums.
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  int out = _mm_cvtsi128_si32(acc);
+
+  for (; i < n; i++) {
+    out += a[i]*b[i];
+  }
+  return out;
+}
+#endif
+
+__attribute__((target("avx2")))
+static int convolve_avx2(const short* a, const short* b, int n)
+{
+  __m256i acc = _mm256_setzero_si256();
+
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+  }
+
+  // Add up the eight partial sums.
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  int out = _mm_cvtsi128_si32(sum);
+
+  for (; i < n; i++) {
+    out += a[i]*b[i];
+  }
+  return out;
+}
+
+#endif
+
+#if RESID_NEON
+static int convolve_neon(const short* a, const short* b, int n)
+{
+  int32x4_t acc0 = vdupq_n_s32(0);
+  int32x4_t acc1 = vdupq_n_s32(0);
+
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t va = vld1q_s16(a + i);
+    int16x8_t vb = vld1q_s16(b + i);
+    acc0 = vmlal_s16(acc0, vget_low_s16(va), vget_low_s16(vb));
+    acc1 = vmlal_s16(acc1, vget_high_s16(va), vget_high_s16(vb));
+  }
+
+  // Add up the eight partial sums.
+  int out = vaddvq_s32(vaddq_s32(acc0, acc1));
+
+  for (; i < n; i++) {
+    out += a[i]*b[i];
+  }
+  return out;
+}
+#endif
+
+bool SID::convolution_kernel_supported(convolution_kernel kernel)
+{
+  switch (kernel) {
+  case CONVOLVE_SCALAR:
+    return true;
+#if RESID_X86
+#ifdef __SSE2__
+  case CONVOLVE_SSE2:
+    return true;
+#endif
+  case CONVOLVE_AVX2:
+    return __builtin_cpu_supports("avx2");
+#endif
+#if RESID_NEON
+  case CONVOLVE_NEON:
+    return true;
+#endif
+  default:
+    return false;
+  }
+}
+
+SID::convolution_kernel SID::best_convolution_kernel()
+{
+  static const convolution_kernel kernels[] = {
+    CONVOLVE_AVX2, CONVOLVE_NEON, CONVOLVE_SSE2
+  };
+
+  for (convolution_kernel kernel : kernels) {
+    if (convolution_kernel_supported(kernel)) return kernel;
+  }
+  return CONVOLVE_SCALAR;
+}
+
+const char* SID::convolution_kernel_name(convolution_kernel kernel)
+{
+  switch (kernel) {
+  case CONVOLVE_SCALAR: return "scalar";
+  case CONVOLVE_SSE2: return "SSE2";
+  case CONVOLVE_AVX2: return "AVX2";
+  case CONVOLVE_NEON: return "NEON";
+  default: return "???";
+  }
+}
+
+bool SID::set_convolution_kernel(convolution_kernel kernel)
+{
+  if (!convolution_kernel_supported(kernel)) {
+    return false;
+  }
+
+  switch (kernel) {
+#if RESID_X86
+#ifdef __SSE2__
+  case CONVOLVE_SSE2: convolve = convolve_sse2; break;
+#endif
+  case CONVOLVE_AVX2: convolve = convolve_avx2; break;
+#endif
+#if RESID_NEON
+  case CONVOLVE_NEON: convolve = convolve_neon; break;
+#endif
+  default: convolve = convolve_scalar; break;
+  }
+
+  this->kernel = kernel;
+  return true;
+}
+
+SID::convolution_kernel SID::get_convolution_kernel() const
+{
+  return kernel;
+}
+
+
 // ----------------------------------------------------------------------------
 // I0() computes the 0th order modified Bessel function of the first kind.
 // This function is originally from resample-1.5/filterkit.c by J. O. Smith.
@@ -567,8 +816,8 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
   if (method != SAMPLE_RESAMPLE && method != SAMPLE_RESAMPLE_FASTMEM)
   {
     delete[] sample;
-    delete[] fir;
     sample = 0;
+    fir_table.reset();
     fir = 0;
     return true;
   }
@@ -620,38 +869,40 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
   int n = (int)ceil(log(res/f_cycles_per_sample)/log(2.0f));
   int fir_RES_new = 1 << n;
 
-  /* Determine if we need to recalculate table, or whether we can reuse earlier cached copy.
-   * This pays off on slow hardware such as current Android devices.
-   */
-  if (fir && fir_RES_new == fir_RES && fir_N_new == fir_N && beta == fir_beta && f_cycles_per_sample == fir_f_cycles_per_sample && fir_filter_scale == filter_scale) {
-      return true;
-  }
   fir_RES = fir_RES_new;
   fir_N = fir_N_new;
-  fir_beta = beta;
-  fir_f_cycles_per_sample = f_cycles_per_sample;
-  fir_filter_scale = filter_scale;
-
-  // Allocate memory for FIR tables.
-  delete[] fir;
-  fir = new short[fir_N*fir_RES];
-
-  // Calculate fir_RES FIR tables for linear interpolation.
-  for (int i = 0; i < fir_RES; i++) {
-    int fir_offset = i*fir_N + fir_N/2;
-    double j_offset = double(i)/fir_RES;
-    // Calculate FIR table. This is the sinc function, weighted by the
-    // Kaiser window.
-    for (int j = -fir_N/2; j <= fir_N/2; j++) {
-      double jx = j - j_offset;
-      double wt = wc*jx/f_cycles_per_sample;
-      double temp = jx/(fir_N/2);
-      double Kaiser = fabs(temp) <= 1 ? I0(beta*sqrt(1 - temp*temp))/I0beta : 0;
-      double sincwt = fabs(wt) >= 1e-6 ? sin(wt)/wt : 1;
-      double val = (1 << FIR_SHIFT)*filter_scale*f_samples_per_cycle*wc/pi*sincwt*Kaiser;
-      fir[fir_offset + j] = (short)round(val);
+
+  // Reuse the tables of this or another SID instance if possible.
+  std::lock_guard<std::mutex> guard(fir_cache_mutex());
+  std::weak_ptr<const short>& entry =
+    fir_cache_lookup(clock_freq, method, sample_freq, pass_freq, filter_scale);
+  fir_table = entry.lock();
+
+  if (!fir_table) {
+    // Allocate memory for FIR tables.
+    short* table = new short[fir_N*fir_RES];
+
+    // Calculate fir_RES FIR tables for linear interpolation.
+    for (int i = 0; i < fir_RES; i++) {
+      int fir_offset = i*fir_N + fir_N/2;
+      double j_offset = double(i)/fir_RES;
+      // Calculate FIR table. This is the sinc function, weighted by the
+      // Kaiser window.
+      for (int j = -fir_N/2; j <= fir_N/2; j++) {
+        double jx = j - j_offset;
+        double wt = wc*jx/f_cycles_per_sample;
+        double temp = jx/(fir_N/2);
+        double Kaiser = fabs(temp) <= 1 ? I0(beta*sqrt(1 - temp*temp))/I0beta : 0;
+        double sincwt = fabs(wt) >= 1e-6 ? sin(wt)/wt : 1;
+        double val = (1 << FIR_SHIFT)*filter_scale*f_samples_per_cycle*wc/pi*sincwt*Kaiser;
+        table[fir_offset + j] = (short)round(val);
+      }
     }
+
+    fir_table = std::shared_ptr<const short>(table, std::default_delete<short[]>());
+    entry = fir_table;
   }
+  fir = fir_table.get();
 
   return true;
 }
@@ -936,14 +1187,11 @@ int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
 
     int fir_offset = sample_offset*fir_RES >> FIXP_SHIFT;
     int fir_offset_rmd = sample_offset*fir_RES & FIXP_MASK;
-    short* fir_start = fir + fir_offset*fir_N;
+    const short* fir_start = fir + fir_offset*fir_N;
     short* sample_start = sample + sample_index - fir_N - 1 + RINGSIZE;
 
     // Convolution with filter impulse response.
-    int v1 = 0;
-    for (int j = 0; j < fir_N; j++) {
-      v1 += sample_start[j]*fir_start[j];
-    }
+    int v1 = convolve(sample_start, fir_start, fir_N);
 
     // Use next FIR table, wrap around to first FIR table using
     // next sample.
@@ -954,10 +1202,7 @@ int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
     fir_start = fir + fir_offset*fir_N;
 
     // Convolution with filter impulse response.
-    int v2 = 0;
-    for (int k = 0; k < fir_N; k++) {
-      v2 += sample_start[k]*fir_start[k];
-    }
+    int v2 = convolve(sample_start, fir_start, fir_N);
 
     // Linear interpolation.
     // fir_offset_rmd is equal for all samples, it can thus be factorized out:
@@ -1002,14 +1247,11 @@ int SID::clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int int
     sample_offset = next_sample_offset & FIXP_MASK;
 
     int fir_offset = sample_offset*fir_RES >> FIXP_SHIFT;
-    short* fir_start = fir + fir_offset*fir_N;
+    const short* fir_start = fir + fir_offset*fir_N;
     short* sample_start = sample + sample_index - fir_N + RINGSIZE;
 
     // Convolution with filter impulse response.
-    int v = 0;
-    for (int j = 0; j < fir_N; j++) {
-      v += sample_start[j]*fir_start[j];
-    }
+    int v = convolve(sample_start, fir_start, fir_N);
 
     v >>= FIR_SHIFT;
 
@@ -31,6 +31,8 @@
 #endif
 #include "extfilt.h"
 #include "pot.h"
+#include <memory>
+#include <mutex>
 
 namespace reSID
 {
@@ -100,9 +102,33 @@ public:
   // 16-bit output (AUDIO OUT).
   int output();
 
+  // Number of FIR tables currently shared among all SID instances.
+  static int fir_cache_size();
+
+  // Implementations of the FIR convolution used for resampling.
+  // All kernels produce bit-identical results.
+  enum convolution_kernel {
+    CONVOLVE_SCALAR,
+    CONVOLVE_SSE2,
+    CONVOLVE_AVX2,
+    CONVOLVE_NEON
+  };
+
+  static bool convolution_kernel_supported(convolution_kernel kernel);
+  static convolution_kernel best_convolution_kernel();
+  static const char* convolution_kernel_name(convolution_kernel kernel);
+  bool set_convolution_kernel(convolution_kernel kernel);
+  convolution_kernel get_convolution_kernel() const;
+
  public:
     
   static double I0(double x);
+  static std::mutex& fir_cache_mutex();
+  static std::weak_ptr<const short>& fir_cache_lookup(double clock_freq,
+                                                      sampling_method method,
+                                                      double sample_freq,
+                                                      double pass_freq,
+                                                      double filter_scale);
   int clock_fast(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_interpolate(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample(cycle_count& delta_t, short* buf, int n, int interleave);
@@ -157,15 +183,19 @@ public:
   short sample_prev, sample_now;
   int fir_N;
   int fir_RES;
-  double fir_beta;
-  double fir_f_cycles_per_sample;
-  double fir_filter_scale;
 
   // Ring buffer with overflow for contiguous storage of RINGSIZE samples.
   short* sample;
 
-  // FIR_RES filter tables (FIR_N*FIR_RES).
-  short* fir;
+  // FIR_RES filter tables (FIR_N*FIR_RES). The tables only depend on the
+  // sampling parameters and are shared by all SID instances using the same
+  // parameters (see fir_cache_lookup()).
+  std::shared_ptr<const short> fir_table;
+  const short* fir;
+
+  // FIR convolution kernel (selected at runtime, see best_convolution_kernel()).
+  convolution_kernel kernel;
+  int (*convolve)(const short* a, const short* b, int n);
 };
 
 
@@ -9,6 +9,7 @@
 
 #include "Checksum.h"
 #include "Macros.h"
+#include <cstring>
 
 namespace util {
 
@@ -54,6 +55,27 @@ fnv_1a_64(const u8 *addr, isize size)
     return hash;
 }
 
+u64
+fnv_1a_64w(const u8 *addr, isize size)
+{
+    if (addr == nullptr || size == 0) return 0;
+    
+    u64 hash = fnv_1a_init64();
+    isize i = 0;
+    
+    for (; i + 8 <= size; i += 8) {
+
+        u64 chunk;
+        std::memcpy(&chunk, addr + i, 8);
+        hash = fnv_1a_it64(hash, chunk);
+    }
+    for (; i < size; i++) {
+        hash = fnv_1a_it64(hash, (u64)addr[i]);
+    }
+    
+    return hash;
+}
+
 u16 crc16(const u8 *addr, isize size)
 {
     u8 x;
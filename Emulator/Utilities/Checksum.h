@@ -25,6 +25,9 @@ u64 fnv_1a_it64(u64 prv, u64 val);
 u32 fnv_1a_32(const u8 *addr, isize size);
 u64 fnv_1a_64(const u8 *addr, isize size);
 
+// Computes a FNV-1a checksum by processing the buffer in 64-bit chunks
+u64 fnv_1a_64w(const u8 *addr, isize size);
+
 // Computes a CRC checksum for a given buffer
 u16 crc16(const u8 *addr, isize size);
 u32 crc32(const u8 *addr, isize size);
@@ -10,6 +10,8 @@
 #include "Chrono.h"
 #ifdef __MACH__
 #include <mach/mach_time.h>
+#else
+#include <time.h>
 #endif
 
 namespace util {
@@ -70,8 +72,8 @@ Time::sleep()
     struct timespec req, rem;
     
     if (ticks > 0) {
-        req.tv_sec = 0;
-        req.tv_nsec = ticks;
+        req.tv_sec = ticks / 1000000000;
+        req.tv_nsec = ticks % 1000000000;
         nanosleep(&req, &rem);
     }
 }
@@ -79,7 +81,7 @@ Time::sleep()
 void
 Time::sleepUntil()
 {
-    (now() - *this).sleep();
+    (*this - now()).sleep();
 }
 
 #endif
@@ -0,0 +1,147 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Compression.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace util {
+
+// Minimum length of a match
+static constexpr isize minMatch = 4;
+
+// Number of trailing bytes that are always encoded as literals
+static constexpr isize tailLiterals = 5;
+
+// Size of the hash table used for finding matches
+static constexpr isize hashBits = 12;
+
+static u32 read32(const u8 *p) { u32 v; std::memcpy(&v, p, 4); return v; }
+static u32 hash(u32 v) { return (v * 2654435761U) >> (32 - hashBits); }
+
+static void writeLength(u8 *&op, isize len)
+{
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = (u8)len;
+}
+
+static bool readLength(const u8 *&ip, const u8 *end, isize &len)
+{
+    u8 byte;
+    do {
+        if (ip >= end) return false;
+        byte = *ip++;
+        len += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+static void writeSequence(u8 *&op, const u8 *lit, isize litLen, isize offset, isize matchLen)
+{
+    isize ml = matchLen ? matchLen - minMatch : 0;
+
+    *op++ = (u8)(std::min(litLen, (isize)15) << 4 | std::min(ml, (isize)15));
+    if (litLen >= 15) writeLength(op, litLen - 15);
+
+    std::memcpy(op, lit, litLen);
+    op += litLen;
+
+    if (matchLen) {
+
+        *op++ = (u8)(offset & 0xFF);
+        *op++ = (u8)(offset >> 8);
+        if (ml >= 15) writeLength(op, ml - 15);
+    }
+}
+
+isize
+lzCompress(const u8 *src, isize len, u8 *dst)
+{
+    assert(len <= lzBlockSize);
+
+    const u8 *ip = src;
+    const u8 *anchor = src;
+    const u8 *end = src + len;
+    u8 *op = dst;
+
+    if (len > minMatch + tailLiterals) {
+
+        u16 table[1 << hashBits] = { };
+        const u8 *limit = end - tailLiterals - minMatch;
+
+        while (ip < limit) {
+
+            u32 seq = read32(ip);
+            u32 h = hash(seq);
+            const u8 *ref = src + table[h];
+            table[h] = (u16)(ip - src);
+
+            if (ref >= ip || read32(ref) != seq) { ip++; continue; }
+
+            // Extend the match as far as possible
+            const u8 *mp = ip + minMatch;
+            const u8 *rp = ref + minMatch;
+            while (mp < end - tailLiterals && *mp == *rp) { mp++; rp++; }
+
+            writeSequence(op, anchor, ip - anchor, ip - ref, mp - ip);
+            ip = anchor = mp;
+        }
+    }
+
+    // Write the remaining bytes as literals
+    writeSequence(op, anchor, end - anchor, 0, 0);
+
+    assert(op - dst <= lzBound(len));
+    return op - dst;
+}
+
+bool
+lzDecompress(const u8 *src, isize len, u8 *dst, isize dstLen)
+{
+    const u8 *ip = src;
+    const u8 *iend = src + len;
+    u8 *op = dst;
+    u8 *oend = dst + dstLen;
+
+    while (ip < iend) {
+
+        u8 token = *ip++;
+
+        // Copy literals
+        isize litLen = token >> 4;
+        if (litLen == 15 && !readLength(ip, iend, litLen)) return false;
+        if (litLen > iend - ip || litLen > oend - op) return false;
+        std::memcpy(op, ip, litLen);
+        ip += litLen;
+        op += litLen;
+
+        // The last sequence has no match
+        if (ip == iend) break;
+
+        // Copy the match (source and target may overlap)
+        if (iend - ip < 2) return false;
+        isize offset = ip[0] | ip[1] << 8;
+        ip += 2;
+
+        isize matchLen = token & 0xF;
+        if (matchLen == 15 && !readLength(ip, iend, matchLen)) return false;
+        matchLen += minMatch;
+
+        if (offset == 0 || offset > op - dst || matchLen > oend - op) return false;
+        const u8 *ref = op - offset;
+        for (isize i = 0; i < matchLen; i++) op[i] = ref[i];
+        op += matchLen;
+    }
+
+    return op == oend;
+}
+
+}
@@ -0,0 +1,43 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+
+namespace util {
+
+/* This file provides a lightweight LZ77 codec for compressing blocks of up to
+ * 64 KB. The compressed data is a sequence of LZ4 style sequences:
+ *
+ *     Token                              (1 byte)
+ *     Extra literal length bytes         (optional)
+ *     Literals                           (0 or more bytes)
+ *     Match offset, little endian        (2 bytes)
+ *     Extra match length bytes           (optional)
+ *
+ * The upper nibble of the token stores the number of literals and the lower
+ * nibble the match length minus 4. A nibble value of 15 is continued by extra
+ * length bytes which are summed up until a byte different from 255 shows up.
+ * The last sequence of a block consists of literals only.
+ */
+
+// Maximum number of bytes in a block
+static constexpr isize lzBlockSize = 0x10000;
+
+// Returns the maximum size of a compressed block
+inline isize lzBound(isize len) { return len + len / 255 + 16; }
+
+// Compresses a block (dst must provide space for lzBound(len) bytes)
+isize lzCompress(const u8 *src, isize len, u8 *dst);
+
+// Decompresses a block (returns false if the data is corrupted)
+bool lzDecompress(const u8 *src, isize len, u8 *dst, isize dstLen);
+
+}
@@ -48,4 +48,90 @@ Wakeable::wakeUp()
 #endif
 }
 
+WorkerPool::WorkerPool(isize numThreads)
+{
+    for (isize i = 0; i < numThreads; i++) {
+        threads.push_back(std::thread(&WorkerPool::main, this));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exit = true;
+    }
+    wakeUpCond.notify_all();
+
+    for (auto &thread : threads) thread.join();
+}
+
+WorkerPool &
+WorkerPool::shared()
+{
+    // The calling thread runs one job itself, hence one thread less is needed
+    static WorkerPool pool(std::max(1U, std::thread::hardware_concurrency()) - 1);
+    return pool;
 }
+
+void
+WorkerPool::run(isize count, const std::function<void(isize)> &func)
+{
+    // Don't queue up behind another instance if the pool is occupied
+    std::unique_lock<std::mutex> batch(batchMutex, std::try_to_lock);
+    if (!batch || threads.empty()) {
+
+        for (isize i = 0; i < count; i++) func(i);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    job = func;
+    numJobs = count;
+    nextJob = 0;
+    pendingJobs = count;
+    generation++;
+
+    wakeUpCond.notify_all();
+
+    // Lend a hand
+    work(lock);
+
+    // Wait until the pool threads have finished their jobs, too
+    doneCond.wait(lock, [this]() { return pendingJobs == 0; });
+}
+
+void
+WorkerPool::work(std::unique_lock<std::mutex> &lock)
+{
+    while (nextJob < numJobs) {
+
+        isize nr = nextJob++;
+
+        lock.unlock();
+        job(nr);
+        lock.lock();
+
+        if (--pendingJobs == 0) doneCond.notify_all();
+    }
+}
+
+void
+WorkerPool::main()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    u64 seen = generation;
+
+    while (true) {
+
+        wakeUpCond.wait(lock, [&]() { return exit || generation != seen; });
+        if (exit) break;
+
+        seen = generation;
+        work(lock);
+    }
+}
+
+}
+
@@ -9,8 +9,12 @@
 
 #pragma once
 
+#include "Types.h"
 #include <thread>
 #include <future>
+#include <condition_variable>
+#include <functional>
+#include <vector>
 
 namespace util {
 
@@ -67,4 +71,53 @@ public:
     void wakeUp();
 };
 
+/* A small pool of persistent threads for running a batch of independent jobs
+ * concurrently. The calling thread participates in executing the batch and
+ * returns once all jobs have been completed. All emulator instances share a
+ * single pool. If the pool is busy with a batch of another instance, the
+ * jobs are executed by the calling thread alone.
+ */
+class WorkerPool
+{
+    std::vector<std::thread> threads;
+
+    // Held by the thread whose batch is currently processed
+    std::mutex batchMutex;
+
+    std::mutex mutex;
+    std::condition_variable wakeUpCond;
+    std::condition_variable doneCond;
+
+    // The current batch
+    std::function<void(isize)> job;
+    isize numJobs = 0;
+    isize nextJob = 0;
+    isize pendingJobs = 0;
+
+    // Incremented with each new batch
+    u64 generation = 0;
+
+    // Set by the destructor to terminate all threads
+    bool exit = false;
+
+public:
+
+    WorkerPool(isize numThreads);
+    ~WorkerPool();
+
+    // Returns the process-wide pool
+    static WorkerPool &shared();
+
+    // Runs job(0) to job(count - 1) and waits for all of them to finish
+    void run(isize count, const std::function<void(isize)> &func);
+
+private:
+
+    // Executes jobs of the current batch until none is left
+    void work(std::unique_lock<std::mutex> &lock);
+
+    // Main function of all pool threads
+    void main();
+};
+
 }
@@ -0,0 +1,189 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Serialization.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace util {
+
+/* This class keeps track of the memory pages that have been modified since a
+ * certain point in time. A page is a block of 256 bytes. The class is used to
+ * create delta snapshots which only contain the pages of RAM and ROM that have
+ * changed since the previous delta snapshot has been taken.
+ *
+ * Inside a snapshot, the modified pages of a memory block are stored as a
+ * record with the following layout:
+ *
+ *     Size of the memory block in bytes   (4 bytes)
+ *     Number of stored pages              (4 bytes)
+ *     Page number and page data           (4 + 256 bytes for each page)
+ *
+ * The last page of a memory block may be shorter than 256 bytes.
+ */
+
+class DirtyPages {
+
+public:
+
+    static constexpr isize pageSize = 256;
+
+private:
+
+    // Size of the tracked memory block in bytes
+    isize bytes = 0;
+
+    // One bit for each page
+    std::vector<u64> bits;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    DirtyPages(isize size = 0) { resize(size); }
+
+    // Adjusts the size of the tracked memory block (marks all pages)
+    void resize(isize size)
+    {
+        bytes = size;
+        bits.assign((numPages() + 63) / 64, 0);
+        markAll();
+    }
+
+
+    //
+    // Accessing
+    //
+
+    // Returns the number of tracked pages
+    isize numPages() const { return (bytes + pageSize - 1) / pageSize; }
+
+    // Returns the number of bytes in a certain page
+    isize pageBytes(isize page) const
+    {
+        return std::min(pageSize, bytes - page * pageSize);
+    }
+
+    // Checks if a page has been modified
+    bool isDirty(isize page) const
+    {
+        return bits[page >> 6] & (1ULL << (page & 63));
+    }
+
+    // Returns the number of modified pages
+    isize count() const
+    {
+        isize result = 0;
+        for (auto word : bits) result += __builtin_popcountll(word);
+        return result;
+    }
+
+
+    //
+    // Marking pages
+    //
+
+    // Marks the page containing a certain address as modified
+    void mark(isize addr)
+    {
+        isize page = addr >> 8;
+        bits[page >> 6] |= 1ULL << (page & 63);
+    }
+
+    // Marks all pages overlapping a certain address range as modified
+    void markRange(isize addr, isize size)
+    {
+        if (size <= 0) return;
+        for (isize p = addr >> 8; p <= (addr + size - 1) >> 8; p++) mark(p << 8);
+    }
+
+    // Marks all pages as modified
+    void markAll()
+    {
+        for (isize p = 0; p < numPages(); p++) mark(p << 8);
+    }
+
+    // Marks all pages as unmodified
+    void clear()
+    {
+        std::fill(bits.begin(), bits.end(), 0);
+    }
+
+
+    //
+    // Serializing
+    //
+
+    // Returns the size of a record storing all modified pages
+    isize deltaSize() const
+    {
+        isize result = 8;
+
+        for (isize p = 0; p < numPages(); p++) {
+            if (isDirty(p)) result += 4 + pageBytes(p);
+        }
+        return result;
+    }
+
+    // Writes all modified pages of a memory block into a buffer
+    isize saveDelta(const u8 *mem, u8 *buffer) const
+    {
+        u8 *ptr = buffer;
+
+        write32(ptr, (u32)bytes);
+        write32(ptr, (u32)count());
+
+        for (isize p = 0; p < numPages(); p++) {
+
+            if (!isDirty(p)) continue;
+
+            write32(ptr, (u32)p);
+            std::memcpy(ptr, mem + p * pageSize, pageBytes(p));
+            ptr += pageBytes(p);
+        }
+
+        return ptr - buffer;
+    }
+
+    // Copies all pages stored in a buffer back into a memory block. Returns
+    // -1 if the buffer does not contain a valid record for this block.
+    isize loadDelta(u8 *mem, const u8 *buffer, const u8 *end) const
+    {
+        const u8 *ptr = buffer;
+
+        if (end - ptr < 8) return -1;
+        isize size = read32(ptr);
+        isize num = read32(ptr);
+        if (size != bytes || num > numPages()) return -1;
+
+        for (isize i = 0; i < num; i++) {
+
+            if (end - ptr < 4) return -1;
+            isize p = read32(ptr);
+            if (p >= numPages()) return -1;
+
+            isize len = pageBytes(p);
+            if (end - ptr < len) return -1;
+
+            std::memcpy(mem + p * pageSize, ptr, len);
+            ptr += len;
+        }
+
+        return ptr - buffer;
+    }
+};
+
+}
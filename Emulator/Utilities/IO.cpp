@@ -11,6 +11,7 @@
 #include <vector>
 #include <fstream>
 #include <algorithm>
+#include <iomanip>
 #include <assert.h>
 
 namespace util {
@@ -0,0 +1,77 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "RomStore.h"
+#include "Checksum.h"
+#include <cassert>
+#include <cstring>
+
+namespace util {
+
+RomStore &
+RomStore::shared()
+{
+    static RomStore store;
+    return store;
+}
+
+u64
+RomStore::key(const u8 *buf, isize len)
+{
+    // Mix in the size to distinguish images that only differ in length
+    return fnv_1a_it64(fnv_1a_64w(buf, len), (u64)len);
+}
+
+u64
+RomStore::add(const u8 *buf, isize len)
+{
+    u64 result = key(buf, len);
+
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto it = images.find(result);
+    if (it == images.end()) {
+        images.emplace(result, std::vector<u8>(buf, buf + len));
+    } else {
+        assert((isize)it->second.size() == len);
+        assert(std::memcmp(it->second.data(), buf, len) == 0);
+    }
+    return result;
+}
+
+bool
+RomStore::restore(u64 key, u8 *buf, isize len) const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    auto it = images.find(key);
+    if (it == images.end() || (isize)it->second.size() != len) return false;
+
+    std::memcpy(buf, it->second.data(), len);
+    return true;
+}
+
+isize
+RomStore::count() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return (isize)images.size();
+}
+
+isize
+RomStore::bytes() const
+{
+    std::lock_guard<std::mutex> guard(mutex);
+
+    isize result = 0;
+    for (auto &it : images) result += (isize)it.second.size();
+    return result;
+}
+
+}
@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace util {
+
+/* This class implements a content-addressed storage for Rom images. Each
+ * image is identified by a 64-bit key which is derived from its contents.
+ * Snapshots only record these keys instead of the Rom data itself and
+ * resolve them when they are restored.
+ *
+ * A single store is shared by all emulator instances of a process. Hence,
+ * identical Roms are stored only once, no matter how many instances or
+ * snapshots refer to them. Images are never removed from the store, because
+ * any snapshot taken in the past might still refer to them.
+ */
+
+class RomStore {
+
+    // Stored images
+    std::unordered_map<u64, std::vector<u8>> images;
+
+    // Protects the image table (the store is shared by multiple threads)
+    mutable std::mutex mutex;
+
+public:
+
+    // Returns the store shared by all emulator instances
+    static RomStore &shared();
+
+    // Computes the key of an image
+    static u64 key(const u8 *buf, isize len);
+
+    // Adds an image if it is not yet stored and returns its key
+    u64 add(const u8 *buf, isize len);
+
+    // Copies an image into a buffer (returns false if the image is unknown)
+    bool restore(u64 key, u8 *buf, isize len) const;
+
+    // Returns the number of stored images and their total size in bytes
+    isize count() const;
+    isize bytes() const;
+};
+
+}
@@ -0,0 +1,71 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+#include <array>
+#include <cstring>
+
+namespace util::swar {
+
+/* This file provides a couple of helper functions for processing eight bytes
+ * in parallel inside a 64-bit register (SIMD within a register). VICII uses
+ * them to draw an entire 8 pixel chunk at once.
+ *
+ * All functions treat a u64 as a sequence of eight bytes in memory order.
+ * Hence, byte i of a chunk always refers to the i-th byte in memory, no matter
+ * which endianess the host machine has. Bit masks are interpreted MSB first,
+ * i.e., bit 7 of a mask refers to byte 0.
+ */
+
+// Byte mask with the most significant bit set in each byte
+static constexpr u64 msbs = 0x8080808080808080;
+
+// Reads or writes eight consecutive bytes
+inline u64 load(const u8 *p) { u64 v; std::memcpy(&v, p, 8); return v; }
+inline void store(u8 *p, u64 v) { std::memcpy(p, &v, 8); }
+
+// Copies a byte into all eight bytes
+inline u64 splat(u8 v) { return u64(v) * 0x0101010101010101; }
+
+// Converts a bit mask into a byte mask (0xFF for each set bit)
+inline const std::array<u64, 256> expandTable = [] {
+
+    std::array<u64, 256> table;
+
+    for (isize mask = 0; mask < 256; mask++) {
+
+        u8 bytes[8];
+        for (isize i = 0; i < 8; i++) bytes[i] = (mask & (0x80 >> i)) ? 0xFF : 0;
+        std::memcpy(&table[mask], bytes, 8);
+    }
+    return table;
+}();
+
+inline u64 expand(u8 mask) { return expandTable[mask]; }
+
+// Converts the most significant bit of each byte into a byte mask
+inline u64 spread(u64 msb) { return ((msb & msbs) >> 7) * 0xFF; }
+
+// Returns a byte mask marking all non-zero bytes
+inline u64 nonZero(u64 x) {
+    return spread((((x & ~msbs) + ~msbs) | x) & msbs);
+}
+
+// Returns a byte mask marking all bytes with x >= y (unsigned)
+inline u64 greaterEqual(u64 x, u64 y) {
+    u64 t = (x | msbs) - (y & ~msbs);
+    return spread((x & ~y) | (~(x ^ y) & t));
+}
+
+// Selects the bytes of a where mask is set and the bytes of b elsewhere
+inline u64 select(u64 mask, u64 a, u64 b) { return (a & mask) | (b & ~mask); }
+
+}
@@ -103,6 +103,12 @@ public:
         pipeline[0] = value;
     }
     
+    // Returns the time of the most recent call to write()
+    i64 lastWrite() const { return timeStamp; }
+
+    // Moves the pipeline forward in time
+    void shift(i64 cycles) { timeStamp += cycles; }
+    
     // Reads the most recent pipeline element
     T current() const { return pipeline[0]; }
     
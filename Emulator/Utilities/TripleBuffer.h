@@ -0,0 +1,137 @@
+// -----------------------------------------------------------------------------
+// This file is part of VirtualC64
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+#include <atomic>
+
+namespace util {
+
+/* This class implements the slot management of a lock-free triple buffer.
+ * It is used to hand over data from a single producer to a single consumer.
+ * At any time, the producer owns the back slot and the consumer owns the
+ * front slot. The third slot (the middle slot) holds the most recently
+ * published item. Publishing and acquiring swap the owned slot with the
+ * middle slot by a single atomic exchange. Hence, none of both sides ever
+ * blocks and the consumer always sees a completely written item.
+ *
+ * Each published item is tagged with a sequence number. Furthermore, the
+ * class counts the items that have been replaced before the consumer has
+ * seen them (dropped items) and the acquisitions that did not yield a new
+ * item (duplicated items).
+ */
+
+class TripleBuffer {
+
+    // Bit 2 of the middle slot indicates that it hasn't been acquired yet
+    static constexpr u8 fresh = 0x4;
+
+    // The middle slot (bits 0 and 1) and the fresh flag (bit 2)
+    std::atomic<u8> middle;
+
+    // The slot owned by the producer
+    isize back;
+
+    // The slot owned by the consumer
+    isize front;
+
+    // The most recently published slot (producer side)
+    isize latest;
+
+    // The sequence numbers of the items stored in the slots
+    u64 seq[3];
+
+    // The number of published items (producer side)
+    u64 published;
+
+    // Statistics
+    std::atomic<u64> dropped;
+    std::atomic<u64> duplicated;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    TripleBuffer() {
+
+        back = 0;
+        middle = 1;
+        front = 2;
+        latest = 1;
+        seq[0] = seq[1] = seq[2] = 0;
+        published = 0;
+        clearStats();
+    }
+
+    void clearStats() { dropped = 0; duplicated = 0; }
+
+
+    //
+    // Producing
+    //
+
+    // Returns the slot the producer is supposed to write into
+    isize writeSlot() const { return back; }
+
+    // Returns the most recently published slot
+    isize latestSlot() const { return latest; }
+
+    // Returns the sequence number of the most recently published item
+    u64 latestSeq() const { return published; }
+
+    // Makes the back slot available to the consumer
+    void publish() {
+
+        seq[back] = ++published;
+        latest = back;
+
+        u8 old = middle.exchange(u8(back) | fresh, std::memory_order_acq_rel);
+        if (old & fresh) dropped.fetch_add(1, std::memory_order_relaxed);
+        back = old & 0x3;
+    }
+
+
+    //
+    // Consuming
+    //
+
+    // Grabs the most recently published item and returns its slot
+    isize acquire() {
+
+        if (!(middle.load(std::memory_order_acquire) & fresh)) {
+
+            duplicated.fetch_add(1, std::memory_order_relaxed);
+            return front;
+        }
+
+        u8 old = middle.exchange(u8(front), std::memory_order_acq_rel);
+        front = old & 0x3;
+        return front;
+    }
+
+    // Returns the slot the consumer is currently reading from
+    isize readSlot() const { return front; }
+
+    // Returns the sequence number of the item the consumer is reading
+    u64 readSeq() const { return seq[front]; }
+
+
+    //
+    // Analyzing
+    //
+
+    u64 getDropped() const { return dropped.load(std::memory_order_relaxed); }
+    u64 getDuplicated() const { return duplicated.load(std::memory_order_relaxed); }
+};
+
+}
@@ -213,6 +213,9 @@ DmaDebugger::setDmaDebugColor(MemAccess type, RgbColor color)
 void
 DmaDebugger::visualizeDma(isize offset, u8 data, MemAccess type)
 {
+    if (config.dmaChannel[type]) {
+        touchedLines[(vic.dmaTexturePtr - vic.dmaTexture) / TEX_WIDTH] = true;
+    }
     visualizeDma((u32 *)vic.dmaTexturePtr + offset, data, type);
 }
 
@@ -228,28 +231,48 @@ DmaDebugger::visualizeDma(u32 *p, u8 data, MemAccess type)
     }
 }
 
+/* Blends two RGBA values in fixed-point arithmetic. Weights range from 0 to
+ * 255 and must add up to 255. Red and blue as well as green and alpha are
+ * processed in parallel inside a single 32-bit integer (two 16-bit lanes).
+ */
+static inline u32 blend(u32 c1, u32 c2, u32 w1, u32 w2)
+{
+    // Divides both 16-bit lanes by 255 (exact for all values up to 255 * 255)
+    auto div255 = [](u32 x) {
+        return ((x + 0x00010001 + ((x >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    };
+    
+    u32 rb = (c1 & 0x00FF00FF) * w1 + (c2 & 0x00FF00FF) * w2;
+    u32 ga = ((c1 >> 8) & 0x00FF00FF) * w1 + ((c2 >> 8) & 0x00FF00FF) * w2;
+    
+    return div255(rb) | div255(ga) << 8 | 0xFF000000;
+}
+
 void
 DmaDebugger::computeOverlay(u32 *emuTexture, u32 *dmaTexture)
 {
-    double weight = config.dmaOpacity / 255.0;
-    
+    /* The loops below are free of branches on purpose. It enables the
+     * compiler to process multiple pixels at once with vector instructions.
+     */
+    u32 w = config.dmaOpacity;
+    u32 v = 255 - w;
+
     switch (config.dmaDisplayMode) {
 
         case DMA_DISPLAY_MODE_FG_LAYER:
-                        
+            
             for (isize y = 0; y < TEX_HEIGHT; y++) {
                 
+                // Skip all lines the DMA debugger hasn't drawn into
+                if (!touchedLines[y]) continue;
+                
                 u32 *emu = emuTexture + (y * TEX_WIDTH);
                 u32 *dma = dmaTexture + (y * TEX_WIDTH);
                 
                 for (isize x = 0; x < TEX_WIDTH; x++) {
                     
-                    if ((dma[x] & 0xFFFFFF) == 0) continue;
-                    
-                    GpuColor emuColor = emu[x];
-                    GpuColor dmaColor = dma[x];
-                    GpuColor mixColor = emuColor.mix(dmaColor, weight);
-                    emu[x] = mixColor.abgr;
+                    u32 mix = blend(emu[x], dma[x], v, w);
+                    emu[x] = (dma[x] & 0xFFFFFF) ? mix : emu[x];
                 }
             }
             break;
@@ -263,13 +286,8 @@ DmaDebugger::computeOverlay(u32 *emuTexture, u32 *dmaTexture)
                 
                 for (isize x = 0; x < TEX_WIDTH; x++) {
                     
-                    if ((dma[x] & 0xFFFFFF) != 0) {
-                        emu[x] = dma[x];
-                    } else {
-                        GpuColor emuColor = emu[x];
-                        GpuColor mixColor = emuColor.shade(weight);
-                        emu[x] = mixColor.abgr;
-                    }
+                    u32 shade = blend(emu[x], 0, v, w);
+                    emu[x] = (dma[x] & 0xFFFFFF) ? dma[x] : shade;
                 }
             }
             break;
@@ -283,10 +301,7 @@ DmaDebugger::computeOverlay(u32 *emuTexture, u32 *dmaTexture)
 
                 for (isize x = 0; x < TEX_WIDTH; x++) {
                     
-                    GpuColor emuColor = emu[x];
-                    GpuColor dmaColor = dma[x];
-                    GpuColor mixColor = dmaColor.mix(emuColor, weight);
-                    emu[x] = mixColor.abgr;
+                    emu[x] = blend(dma[x], emu[x], v, w);
                 }
             }
             break;
@@ -294,16 +309,15 @@ DmaDebugger::computeOverlay(u32 *emuTexture, u32 *dmaTexture)
         default:
             fatalError;
     }
+    
+    touchedLines.reset();
 }
 
 void
 DmaDebugger::cutLayers()
 {
-    // Check master switch
-    if (!(config.cutLayers & 0x1000)) return;
-    
-    // Only proceed if at least one channel is enabled
-    if (!(config.cutLayers & 0x0F00)) return;
+    // Only proceed if at least one layer is cut out
+    if (!cutsLayers()) return;
     
     u32 *emuTexturePtr = vic.emuTexturePtr;
     u8 *zBuffer = vic.zBuffer;
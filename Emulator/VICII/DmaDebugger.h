@@ -12,6 +12,9 @@
 #include "DmaDebuggerTypes.h"
 #include "SubComponent.h"
 #include "Colors.h"
+#include "Constants.h"
+
+#include <bitset>
 
 class DmaDebugger : public SubComponent {
 
@@ -23,6 +26,9 @@ class DmaDebugger : public SubComponent {
     // Color lookup table. There are 6 colors with different shades
     u32 debugColor[6][4];
 
+    // Scanlines of the DMA texture that have been drawn into in this frame
+    std::bitset<TEX_HEIGHT> touchedLines;
+
     
     //
     // Initializing
@@ -98,6 +104,11 @@ public:
     
 public:
     
+    // Checks if at least one graphics layer is cut out
+    bool cutsLayers() const {
+        return (config.cutLayers & 0x1000) && (config.cutLayers & 0x0F00);
+    }
+
     // Cuts out certain graphics layers
     void cutLayers();
 };
@@ -295,10 +295,9 @@ Recorder::prepare()
         samplesPerFrame = 735;
     }
     
-    // Start with a nearly empty buffer
-    muxer.stream.lock();
-    while (muxer.stream.count() > 1) muxer.stream.read();
-    muxer.stream.unlock();
+    // Start with an empty buffer
+    audioPos = muxer.stream.w.load();
+    muxer.stream.requestSkip(audioPos);
 
     // Switch state and inform the GUI
     state = State::record;
@@ -346,18 +345,21 @@ Recorder::recordVideo()
 void
 Recorder::recordAudio()
 {
-    if (muxer.stream.count() != samplesPerFrame) {
+    auto &stream = muxer.stream;
+    isize w = stream.w.load();
+    isize available = (stream.cap() + w - audioPos) % stream.cap();
+    
+    if (available != samplesPerFrame) {
         
-        trace(REC_DEBUG, "Samples: %zd\n", muxer.stream.count());
-        assert(muxer.stream.count() >= samplesPerFrame);
+        trace(REC_DEBUG, "Samples: %zd\n", available);
     }
     
     for (isize i = 0; i < samplesPerFrame; i++) {
     
         isize written = 0;
         
-        // Feed the audio pipe
-        SamplePair pair = muxer.stream.read();
+        // Feed the audio pipe (fill up with silence if samples are missing)
+        SamplePair pair = i < available ? stream.element(audioPos + i) : SamplePair { 0, 0 };
         written += write(audioPipe, &pair.left, sizeof(float));
         written += write(audioPipe, &pair.right, sizeof(float));
         
@@ -366,7 +368,9 @@ Recorder::recordAudio()
         }
     }
     
-    muxer.stream.clear();
+    // Drop all remaining samples of this frame
+    audioPos = w;
+    stream.requestSkip(audioPos);
 }
 
 void
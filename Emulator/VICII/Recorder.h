@@ -69,6 +69,12 @@ class Recorder : public SubComponent {
 
     // Sound samples per frame (882 for PAL, 735 for NTSC)
     isize samplesPerFrame = 0;
+
+    /* Position of the next sound sample to record. The recorder taps the
+     * stereo stream without consuming from it. Processed samples are dropped
+     * by the audio thread which is the only consumer of the stream.
+     */
+    isize audioPos = 0;
     
     // The texture cutout that is going to be recorded
     struct { isize x1; isize y1; isize x2; isize y2; } cutout;
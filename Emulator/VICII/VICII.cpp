@@ -10,6 +10,7 @@
 #include "config.h"
 #include "VICII.h"
 #include "C64.h"
+#include "Checksum.h"
 #include "IO.h"
 
 #define SPR0 0x01
@@ -29,6 +30,14 @@ VICII::VICII(C64 &ref) : SubComponent(ref), dmaDebugger(ref)
     baLine.setClock(&cpu.cycle);
     gAccessResult.setClock(&cpu.cycle);
     
+    // Create the texture buffers
+    for (isize i = 0; i < 3; i++) {
+        
+        idxTextures[i] = new u8[TEX_HEIGHT * TEX_WIDTH]();
+        emuTextures[i] = new u32[TEX_HEIGHT * TEX_WIDTH];
+        dmaTextures[i] = new u32[TEX_HEIGHT * TEX_WIDTH];
+    }
+    
     // Create random background noise pattern
     const isize noiseSize = 16 * 512 * 512;
     noise = new u32[noiseSize];
@@ -37,6 +46,18 @@ VICII::VICII(C64 &ref) : SubComponent(ref), dmaDebugger(ref)
     }
 }
 
+VICII::~VICII()
+{
+    delete [] noise;
+    
+    for (isize i = 0; i < 3; i++) {
+        
+        delete [] idxTextures[i];
+        delete [] emuTextures[i];
+        delete [] dmaTextures[i];
+    }
+}
+
 void 
 VICII::_reset(bool hard)
 {
@@ -65,26 +86,27 @@ VICII::_reset(bool hard)
         lowerComparisonVal = lowerComparisonValue();
         
         // Reset the screen buffer pointers
-        emuTexture = emuTexture1;
-        dmaTexture = dmaTexture1;
+        idxTexture = idxTextures[frames.writeSlot()];
+        emuTexture = emuTextures[frames.writeSlot()];
+        dmaTexture = dmaTextures[frames.writeSlot()];
     }
 }
 
 void
 VICII::resetEmuTexture(isize nr)
 {
-    assert(nr == 1 || nr == 2);
+    assert(nr >= 0 && nr < 3);
 
-    if (nr == 1) { resetTexture(emuTexture1); }
-    if (nr == 2) { resetTexture(emuTexture2); }
+    std::memset(idxTextures[nr], 0, TEX_HEIGHT * TEX_WIDTH);
+    resetTexture(emuTextures[nr]);
 }
 
 void
 VICII::resetDmaTexture(isize nr)
 {
-    assert(nr == 1 || nr == 2);
+    assert(nr >= 0 && nr < 3);
     
-    u32 *p = nr == 1 ? dmaTexture1 : dmaTexture2;
+    u32 *p = dmaTextures[nr];
 
     for (int i = 0; i < TEX_HEIGHT * TEX_WIDTH; i++) {
         p[i] = 0xFF000000;
@@ -117,6 +139,58 @@ VICII::resetTexture(u32 *p)
     }
 }
 
+void
+VICII::colorize(const u8 *src, u32 *dst, isize count) const
+{
+    for (isize i = 0; i < count; i++) {
+        dst[i] = rgbaTable[src[i] & 0xF];
+    }
+}
+
+void
+VICII::colorize(const u8 *src, u32 *dst) const
+{
+    // Only convert the used area (the rest contains the checkerboard pattern)
+    isize width = isPAL ? PAL_PIXELS : NTSC_PIXELS;
+    isize height = getLinesPerFrame();
+
+    for (isize y = 0; y < height; y++) {
+        colorize(src + y * TEX_WIDTH, dst + y * TEX_WIDTH, width);
+    }
+}
+
+void
+VICII::hashLines(isize slot, bool overlay)
+{
+    isize width = isPAL ? PAL_PIXELS : NTSC_PIXELS;
+    isize height = getLinesPerFrame();
+    
+    const u64 *prev = lineHashes[frames.latestSlot()];
+    u64 *hashes = lineHashes[slot];
+
+    // Take the palette into account (it determines the RGBA values)
+    u64 palette = util::fnv_1a_64w((u8 *)rgbaTable, sizeof(rgbaTable));
+    
+    for (isize y = 0; y < TEX_HEIGHT; y++) {
+        
+        u64 hash = 0;
+        
+        if (y < height) {
+            
+            // Hash the RGBA texture if the DMA debugger has modified it
+            if (overlay) {
+                hash = util::fnv_1a_64w((u8 *)(emuTextures[slot] + y * TEX_WIDTH), 4 * width);
+            } else {
+                hash = util::fnv_1a_64w(idxTextures[slot] + y * TEX_WIDTH, width);
+                hash = util::fnv_1a_it64(hash, palette);
+            }
+        }
+        
+        hashes[y] = hash;
+        dirtyLines[slot][y] = hash != prev[y];
+    }
+}
+
 VICIIConfig
 VICII::getDefaultConfig()
 {
@@ -134,6 +208,8 @@ VICII::getDefaultConfig()
     defaults.saturation = 50;
     
     defaults.hideSprites = false;
+
+    defaults.rgbaOutput = true;
     
     defaults.checkSSCollisions = true;
     defaults.checkSBCollisions = true;
@@ -158,6 +234,8 @@ VICII::resetConfig()
     setConfigItem(OPT_SATURATION, defaults.saturation);
 
     setConfigItem(OPT_HIDE_SPRITES, defaults.hideSprites);
+
+    setConfigItem(OPT_VIC_RGBA_OUTPUT, defaults.rgbaOutput);
     
     setConfigItem(OPT_SB_COLLISIONS, defaults.checkSSCollisions);
     setConfigItem(OPT_SS_COLLISIONS, defaults.checkSBCollisions);
@@ -171,6 +249,7 @@ VICII::getConfigItem(Option option) const
         case OPT_VIC_REVISION:      return config.revision;
         case OPT_VIC_SPEED:         return config.speed;
         case OPT_VIC_POWER_SAVE:    return config.powerSave;
+        case OPT_VIC_RGBA_OUTPUT:   return config.rgbaOutput;
         case OPT_PALETTE:           return config.palette;
         case OPT_BRIGHTNESS:        return config.brightness;
         case OPT_CONTRAST:          return config.contrast;
@@ -213,6 +292,11 @@ VICII::setConfigItem(Option option, i64 value)
             
             config.powerSave = value;
             return;
+
+        case OPT_VIC_RGBA_OUTPUT:
+
+            config.rgbaOutput = value;
+            return;
             
         case OPT_PALETTE:
             
@@ -430,6 +514,8 @@ VICII::_dump(dump::Category category, std::ostream& os) const
         os << VICIISpeedEnum::key(config.speed) << std::endl;
         os << tab("Power save mode");
         os << bol(config.powerSave, "during warp", "never") << std::endl;
+        os << tab("RGBA output");
+        os << bol(config.rgbaOutput) << std::endl;
         os << tab("Gray dot bug");
         os << bol(config.grayDotBug) << std::endl;
         os << tab("PAL");
@@ -518,6 +604,12 @@ VICII::_dump(dump::Category category, std::ostream& os) const
         os << hex(expansionFF) << std::endl;
         os << tab("expansionFF");
         os << hex(expansionFF) << std::endl;
+        os << tab("Published frames");
+        os << dec(frames.latestSeq()) << std::endl;
+        os << tab("Dropped frames");
+        os << dec(frames.getDropped()) << std::endl;
+        os << tab("Duplicated frames");
+        os << dec(frames.getDuplicated()) << std::endl;
     }
 }
 
@@ -549,6 +641,18 @@ VICII::clearStats()
     }
 }
 
+VICIIFrameStats
+VICII::getFrameStats() const
+{
+    VICIIFrameStats result;
+    
+    result.published = frames.latestSeq();
+    result.dropped = frames.getDropped();
+    result.duplicated = frames.getDuplicated();
+    
+    return result;
+}
+
 SpriteInfo
 VICII::getSpriteInfo(int nr)
 {
@@ -722,16 +826,28 @@ VICII::isVBlankLine(isize line) const
     }
 }
 
+u8 *
+VICII::stableIdxTexture() const
+{
+    return idxTextures[frames.latestSlot()];
+}
+
 u32 *
 VICII::stableEmuTexture() const
 {
-    return emuTexture == emuTexture1 ? emuTexture2 : emuTexture1;
+    return emuTextures[frames.latestSlot()];
 }
 
 u32 *
 VICII::stableDmaTexture() const
 {
-    return dmaTexture == dmaTexture1 ? dmaTexture2 : dmaTexture1;
+    return dmaTextures[frames.latestSlot()];
+}
+
+u32 *
+VICII::acquireEmuTexture()
+{
+    return emuTextures[frames.acquire()];
 }
 
 u32 *
@@ -1123,7 +1239,16 @@ VICII::beginFrame()
     // Clear statistics
     clearStats();
     
+    // Check if this frame needs to be converted to RGBA line by line
+    convertLines = dmaDebugger.cutsLayers();
+
     // Check if this frame should be executed in headless mode
+    updateHeadlessMode();
+}
+
+void
+VICII::updateHeadlessMode()
+{
     headless = c64.inWarpMode() && config.powerSave && (c64.frame % 8) != 0;
 }
 
@@ -1131,28 +1256,28 @@ void
 VICII::endFrame()
 {
     // Only proceed if the current frame hasn't been executed in headless mode
-    if (headless) return;
+    if (headless || c64.inFastForwardMode()) return;
     
-    // Run the DMA debugger if enabled
     bool debug = dmaDebugger.config.dmaDebug;
+    bool rgba = convertLines || config.rgbaOutput || debug;
+
+    // Convert the index texture to RGBA unless this has been done already
+    if (rgba && !convertLines) colorize(idxTexture, emuTexture);
+
+    // Run the DMA debugger if enabled
     if (debug) dmaDebugger.computeOverlay(emuTexture, dmaTexture);
 
-    // Switch texture buffers
-    if (emuTexture == emuTexture1) {
-        
-        assert(dmaTexture == dmaTexture1);
-        emuTexture = emuTexture2;
-        dmaTexture = dmaTexture2;
-        if (debug) { resetEmuTexture(2); resetDmaTexture(2); }
+    // Compute the scanline fingerprints
+    hashLines(frames.writeSlot(), debug || convertLines);
 
-    } else {
-        
-        assert(emuTexture == emuTexture2);
-        assert(dmaTexture == dmaTexture2);
-        emuTexture = emuTexture1;
-        dmaTexture = dmaTexture1;
-        if (debug) { resetEmuTexture(1); resetDmaTexture(1); }
-    }
+    // Publish the finished frame and switch to the released texture buffers
+    frames.publish();
+    
+    isize slot = frames.writeSlot();
+    idxTexture = idxTextures[slot];
+    emuTexture = emuTextures[slot];
+    dmaTexture = dmaTextures[slot];
+    if (debug) { resetEmuTexture(slot); resetDmaTexture(slot); }
 }
 
 void
@@ -1202,6 +1327,7 @@ VICII::beginScanline(u16 line)
     verticalFrameFFsetCond = false;
 
     // Adjust the texture pointers
+    idxTexturePtr = idxTexture + line * TEX_WIDTH;
     emuTexturePtr = emuTexture + line * TEX_WIDTH;
     dmaTexturePtr = dmaTexture + line * TEX_WIDTH;
 
@@ -1219,6 +1345,11 @@ VICII::beginScanline(u16 line)
     
     // Reset the pixel buffer offset
     bufferoffset = 0;
+    
+    // In fast-forward mode, only draw lines that might cause sprite collisions
+    if (c64.inFastForwardMode()) {
+        headless = !(spriteDisplay | spriteDisplayDelayed | spriteDmaOnOff);
+    }
 }
 
 void 
@@ -1227,8 +1358,15 @@ VICII::endScanline()
     // Set vertical flipflop if condition was hit
     if (verticalFrameFFsetCond) setVerticalFrameFF(true);
     
+    // Nothing has been drawn in headless mode
+    if (headless) return;
+    
     // Cut out layers if requested
-    dmaDebugger.cutLayers();
+    if (convertLines) {
+        
+        colorize(idxTexturePtr, emuTexturePtr, isPAL ? PAL_PIXELS : NTSC_PIXELS);
+        dmaDebugger.cutLayers();
+    }
 
     // Prepare buffers for the next line
     for (isize i = 0; i < TEX_WIDTH; i++) { zBuffer[i] = 0; }
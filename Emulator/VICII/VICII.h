@@ -16,6 +16,9 @@
 #include "DmaDebugger.h"
 #include "MemoryTypes.h"
 #include "TimeDelayed.h"
+#include "TripleBuffer.h"
+
+#include <bitset>
 
 class VICII : public SubComponent {
 
@@ -499,27 +502,45 @@ private:
     u32 *noise;
 
     /* Texture buffers. VICII outputs the generated texture into these buffers.
-     * At any time, one buffer is the working buffer and the other one is the
-     * stable buffer. While VICII always writes into the working buffer, the
-     * GUI accesses the stable buffer at a constant frame rate and copies it
-     * into the texture RAM of the graphics card.
+     * The buffers are organized as a triple buffer. At any time, one buffer
+     * is the working buffer, one buffer holds the most recently finished
+     * frame, and one buffer is read by the GUI. While VICII always writes
+     * into the working buffer, the GUI grabs the most recent frame at a
+     * constant frame rate and copies it into the texture RAM of the graphics
+     * card. Because the buffers are exchanged atomically, the GUI never sees
+     * a partially drawn frame and the emulator thread never blocks.
      *
-     * The emuTexture buffers contain the emulator texture. It is the texture
-     * that is usually drawn by the GUI. The dmaTexture buffers contain the
-     * texture generated by the DMA debugger. If DMA debugging is enabled, this
-     * texture is superimposed on the emulator texture.
-     */
-    u32 *emuTexture1 = new u32[TEX_HEIGHT * TEX_WIDTH];
-    u32 *emuTexture2 = new u32[TEX_HEIGHT * TEX_WIDTH];
-    u32 *dmaTexture1 = new u32[TEX_HEIGHT * TEX_WIDTH];
-    u32 *dmaTexture2 = new u32[TEX_HEIGHT * TEX_WIDTH];
-    /*
-     */
+     * The idxTexture buffers contain the emulator texture as a sequence of
+     * C64 color indices. They are written by the drawing routines. At the end
+     * of each frame, the index texture is converted to RGBA and stored in the
+     * emuTexture buffers. It is the texture that is usually drawn by the GUI.
+     * The dmaTexture buffers contain the texture generated by the DMA
+     * debugger. If DMA debugging is enabled, this texture is superimposed on
+     * the emulator texture.
+     */
+    u8 *idxTextures[3];
+    u32 *emuTextures[3];
+    u32 *dmaTextures[3];
+
+    // Slot management of the triple buffer
+    util::TripleBuffer frames;
+
+    /* Scanline fingerprints. When a frame is finished, a hash value is
+     * computed for each scanline of the texture buffer. Consumers can compare
+     * these values with the ones of the frame they have processed last to
+     * find out which lines have changed. Lines outside the used area have a
+     * hash value of 0.
+     */
+    u64 lineHashes[3][TEX_HEIGHT] = { };
+
+    // Lines that differ from the previously finished frame
+    std::bitset<TEX_HEIGHT> dirtyLines[3];
      
-    /* Pointer to the current working texture. This variable points either to
-     * the first or the second texture buffer. After a frame has been finished,
-     * the pointer is redirected to the other buffer.
+    /* Pointer to the current working texture. This variable points to one of
+     * the three texture buffers. After a frame has been finished, the pointer
+     * is redirected to the buffer that has been released by the GUI.
      */
+    u8 *idxTexture;
     u32 *emuTexture;
     u32 *dmaTexture;
 
@@ -529,9 +550,17 @@ private:
      * the first or the second texture buffer. They are reset at the beginning
      * of each frame and incremented at the beginning of each scanline.
      */
+    u8 *idxTexturePtr;
     u32 *emuTexturePtr;
     u32 *dmaTexturePtr;
 
+    /* Indicates if the current frame is converted to RGBA line by line. This
+     * is only the case if the DMA debugger cuts out layers, because it needs
+     * to modify the RGBA values of the current scanline. In all other cases,
+     * the whole frame is converted at once in endFrame().
+     */
+    bool convertLines = false;
+
     /* VICII utilizes a depth buffer to determine pixel priority. The render
      * routines only write a color value, if it is closer to the view point.
      * The depth of the closest pixel is kept in this buffer. The lower the
@@ -573,17 +602,30 @@ public:
 public:
 	
     VICII(C64 &ref);
+    ~VICII();
 
     void updateVicFunctionTable();
 
+    // Decides whether the current frame is executed in headless mode
+    void updateHeadlessMode();
+
 private:
     
     void resetEmuTexture(isize nr);
-    void resetEmuTextures() { resetEmuTexture(1); resetEmuTexture(2); }
+    void resetEmuTextures() { for (isize i = 0; i < 3; i++) resetEmuTexture(i); }
     void resetDmaTexture(isize nr);
-    void resetDmaTextures() { resetDmaTexture(1); resetDmaTexture(2); }
+    void resetDmaTextures() { for (isize i = 0; i < 3; i++) resetDmaTexture(i); }
     void resetTexture(u32 *p);
 
+    // Translates a sequence of color indices into RGBA values
+    void colorize(const u8 *src, u32 *dst, isize count) const;
+
+    // Translates the used area of an index texture into RGBA values
+    void colorize(const u8 *src, u32 *dst) const;
+
+    // Computes the scanline fingerprints of a finished frame
+    void hashLines(isize slot, bool overlay);
+
     template <u16 flags> ViciiFunc getViciiFunc(isize cycle);
 
     
@@ -736,6 +778,7 @@ public:
     VICIIInfo getInfo() const { return C64Component::getInfo(info); }
     SpriteInfo getSpriteInfo(int nr);
     VICIIStats getStats() { return stats; }
+    VICIIFrameStats getFrameStats() const;
     
 private:
     
@@ -799,9 +842,35 @@ public:
     // Accessing the screen buffer and display properties
     //
     
-    // Returns pointers to the stable textures
+    /* Returns pointers to the textures of the most recently finished frame.
+     * These functions are meant to be called from the emulator thread or
+     * while the emulator is suspended.
+     */
+    u8 *stableIdxTexture() const;
     u32 *stableEmuTexture() const;
     u32 *stableDmaTexture() const;
+
+    /* Hands the most recently finished frame over to the GUI. The returned
+     * texture remains valid until the function is called again. This is the
+     * only function the GUI is allowed to call while the emulator is running.
+     */
+    u32 *acquireEmuTexture();
+
+    // Returns the sequence number of the most recently acquired frame
+    u64 acquiredFrame() const { return frames.readSeq(); }
+
+    // Returns the scanline fingerprints of the finished or acquired frame
+    const u64 *stableLineHashes() const { return lineHashes[frames.latestSlot()]; }
+    const u64 *acquiredLineHashes() const { return lineHashes[frames.readSlot()]; }
+
+    /* Returns the lines that differ from the previously finished frame. Note
+     * that the GUI may skip frames. Consumers that don't process every frame
+     * need to compare the scanline fingerprints instead.
+     */
+    const std::bitset<TEX_HEIGHT> &stableDirtyLines() const {
+        return dirtyLines[frames.latestSlot()]; }
+    const std::bitset<TEX_HEIGHT> &acquiredDirtyLines() const {
+        return dirtyLines[frames.readSlot()]; }
     
     // Returns a pointer to randon noise
     u32 *getNoise() const;
@@ -1264,6 +1333,14 @@ private:
     void drawCanvasFastPath();
     void drawCanvasSlowPath();
 
+    /* Draws the canvas pixels from .. to-1 in a single pass. This function is
+     * used when the fast path is taken. The pixels are merged into the
+     * provided 8 pixel chunks (one byte per pixel).
+     */
+    template <DisplayMode mode>
+    void drawCanvasSegment(isize from, isize to, u64 &pixels, u64 &depths);
+    template <DisplayMode mode> void drawCanvasFastPath();
+
     // Draws a single canvas pixel
     void drawCanvasPixel(u8 pixel, u8 mode, u8 d016);
     
@@ -1282,9 +1359,11 @@ private:
     void drawSpritesSlowPath();
     
     /* Draws all sprite pixels for a single sprite. This function is used when
-     * the fast path is taken.
+     * the fast path is taken. The pixels are merged into the provided 8 pixel
+     * chunks (one byte per pixel).
      */
-    template <bool multicolor> void drawSpriteNr(isize nr, bool enable, bool active);
+    template <bool multicolor> void drawSpriteNr(isize nr, bool enable, bool active,
+                                                 u64 &pixels, u64 &depths, u64 &coll);
 
     /* Draws a single sprite pixel for all sprites. This function is used when
      * the slow path is taken.
@@ -1305,7 +1384,7 @@ private:
     
     // Writes a single color value into the screenbuffer
     #define COLORIZE(index,color) \
-        emuTexturePtr[index] = rgbaTable[color];
+        idxTexturePtr[index] = (u8)(color);
     
     // Sets a single frame pixel
     #define SET_FRAME_PIXEL(pixel,color) { \
@@ -399,6 +399,9 @@ typedef struct
     // Sprites
     bool hideSprites;
     
+    // Output
+    bool rgbaOutput;
+
     // Cheating
     bool checkSSCollisions;
     bool checkSBCollisions;
@@ -417,6 +420,15 @@ typedef struct
 }
 VICIIStats;
 
+typedef struct
+{
+    // Frame handoff between VICII and the GUI
+    u64 published;
+    u64 dropped;
+    u64 duplicated;
+}
+VICIIFrameStats;
+
 typedef struct
 {
     bool vertical;
@@ -10,6 +10,7 @@
 #include "config.h"
 #include "VICII.h"
 #include "C64.h"
+#include "Swar.h"
 
 void
 VICII::drawBorder()
@@ -70,125 +71,154 @@ void
 VICII::drawCanvasFastPath()
 {
     if (VIC_STATS) stats.canvasFastPath++;
-            
-    u8 xscroll = reg.delayed.xscroll;
     
     switch (reg.delayed.mode) {
-    
+            
         case DISPLAY_MODE_STANDARD_TEXT:
-
-            for (isize i = 0; i < 8; i++) {
-                
-                if (i == xscroll) loadShiftRegister();
-                sr.colorbits = (sr.data >> 7);
-                
-                if (sr.colorbits) {
-                    SET_FG_PIXEL(i, sr.latchedCol);
-                } else {
-                    SET_BG_PIXEL(i, reg.delayed.colors[COLREG_BG0]);
-                }
-                
-                sr.data <<= 1;
-                sr.mcFlop = !sr.mcFlop;
-            }
+            
+            drawCanvasFastPath <DISPLAY_MODE_STANDARD_TEXT> ();
             return;
             
         case DISPLAY_MODE_MULTICOLOR_TEXT:
             
-            for (isize i = 0; i < 8; i++) {
-                
-                if (i == xscroll) loadShiftRegister();
-                bool mc = sr.latchedCol & 0x8;
-                
-                if (mc) {
-                    
-                    if (sr.mcFlop) sr.colorbits = sr.data >> 6;
-                    
-                    switch (sr.colorbits) {
-                        case 0: SET_BG_PIXEL(i, reg.delayed.colors[COLREG_BG0]); break;
-                        case 1: SET_BG_PIXEL(i, reg.delayed.colors[COLREG_BG1]); break;
-                        case 2: SET_FG_PIXEL(i, reg.delayed.colors[COLREG_BG2]); break;
-                        case 3: SET_FG_PIXEL(i, sr.latchedCol & 0x07); break;
-                    }
-                    
-                } else {
-                    
-                    sr.colorbits = (sr.data >> 7);
-                    
-                    if (sr.colorbits) {
-                        SET_FG_PIXEL(i, sr.latchedCol);
-                    } else {
-                        SET_BG_PIXEL(i, reg.delayed.colors[COLREG_BG0]);
-                    }
-                }
-                
-                sr.data <<= 1;
-                sr.mcFlop = !sr.mcFlop;
-            }
+            drawCanvasFastPath <DISPLAY_MODE_MULTICOLOR_TEXT> ();
             return;
 
         case DISPLAY_MODE_STANDARD_BITMAP:
             
-            for (isize i = 0; i < 8; i++) {
-                
-                if (i == xscroll) loadShiftRegister();
-                sr.colorbits = (sr.data >> 7);
-                
-                if (sr.colorbits) {
-                    SET_FG_PIXEL(i, HI_NIBBLE(sr.latchedChr));
-                } else {
-                    SET_BG_PIXEL(i, LO_NIBBLE(sr.latchedChr));
-                }
-
-                sr.data <<= 1;
-                sr.mcFlop = !sr.mcFlop;
-            }
+            drawCanvasFastPath <DISPLAY_MODE_STANDARD_BITMAP> ();
             return;
 
         case DISPLAY_MODE_MULTICOLOR_BITMAP:
             
-            for (isize i = 0; i < 8; i++) {
-                
-                if (i == xscroll) loadShiftRegister();
-                if (sr.mcFlop) sr.colorbits = sr.data >> 6;
-                
-                switch (sr.colorbits) {
-                    case 0: SET_BG_PIXEL(i, reg.delayed.colors[COLREG_BG0]); break;
-                    case 1: SET_BG_PIXEL(i, HI_NIBBLE(sr.latchedChr)); break;
-                    case 2: SET_FG_PIXEL(i, LO_NIBBLE(sr.latchedChr)); break;
-                    case 3: SET_FG_PIXEL(i, sr.latchedCol); break;
-                }
-                    
-                sr.data <<= 1;
-                sr.mcFlop = !sr.mcFlop;
-            }
+            drawCanvasFastPath <DISPLAY_MODE_MULTICOLOR_BITMAP> ();
             return;
 
         case DISPLAY_MODE_EXTENDED_BG_COLOR:
             
-            for (isize i = 0; i < 8; i++) {
-                
-                if (i == xscroll) loadShiftRegister();
-                sr.colorbits = (sr.data >> 7);
-                
-                if (sr.colorbits) {
-                    SET_FG_PIXEL(i, sr.latchedCol);
-                } else {
-                    isize regnr = COLREG_BG0 + (sr.latchedChr >> 6);
-                    SET_BG_PIXEL(i, reg.delayed.colors[regnr]);
-                }
-
-                sr.data <<= 1;
-                sr.mcFlop = !sr.mcFlop;
-            }
+            drawCanvasFastPath <DISPLAY_MODE_EXTENDED_BG_COLOR> ();
             return;
 
         default:
-
+            
             // Invalid color modes (no speedup necessary)
             drawCanvasSlowPath();
+            return;
+    }
+}
+
+template <DisplayMode mode> void
+VICII::drawCanvasFastPath()
+{
+    u8 xscroll = reg.delayed.xscroll;
+    u64 pixels = 0;
+    u64 depths = 0;
+    
+    // Draw the pixels in front of and behind the shift register reload
+    drawCanvasSegment <mode> (0, xscroll, pixels, depths);
+    loadShiftRegister();
+    drawCanvasSegment <mode> (xscroll, 8, pixels, depths);
+    
+    util::swar::store(idxTexturePtr + bufferoffset, pixels);
+    util::swar::store(zBuffer + bufferoffset, depths);
+}
+
+template <DisplayMode mode> void
+VICII::drawCanvasSegment(isize from, isize to, u64 &pixels, u64 &depths)
+{
+    isize n = to - from;
+    if (n == 0) return;
+    
+    /* The color bits of all pixels are computed as two bit planes (bit 7
+     * corresponds to pixel 0). In single-color mode, a set pixel is stored
+     * as color bits 11 and an unset pixel as color bits 00.
+     */
+    u8 data = sr.data;
+    u8 plane1, plane0;
+    u8 col[4] = { 0, 0, 0, 0 };
+    bool mc = false;
+    
+    switch (mode) {
+            
+        case DISPLAY_MODE_STANDARD_TEXT:
+            
+            col[0] = reg.delayed.colors[COLREG_BG0];
+            col[3] = sr.latchedCol;
+            break;
+            
+        case DISPLAY_MODE_MULTICOLOR_TEXT:
+            
+            mc = sr.latchedCol & 0x8;
+            col[0] = reg.delayed.colors[COLREG_BG0];
+            col[1] = reg.delayed.colors[COLREG_BG1];
+            col[2] = reg.delayed.colors[COLREG_BG2];
+            col[3] = mc ? sr.latchedCol & 0x07 : sr.latchedCol;
             break;
+            
+        case DISPLAY_MODE_STANDARD_BITMAP:
+            
+            col[0] = LO_NIBBLE(sr.latchedChr);
+            col[3] = HI_NIBBLE(sr.latchedChr);
+            break;
+            
+        case DISPLAY_MODE_MULTICOLOR_BITMAP:
+            
+            mc = true;
+            col[0] = reg.delayed.colors[COLREG_BG0];
+            col[1] = HI_NIBBLE(sr.latchedChr);
+            col[2] = LO_NIBBLE(sr.latchedChr);
+            col[3] = sr.latchedCol;
+            break;
+            
+        case DISPLAY_MODE_EXTENDED_BG_COLOR:
+            
+            col[0] = reg.delayed.colors[COLREG_BG0 + (sr.latchedChr >> 6)];
+            col[3] = sr.latchedCol;
+            break;
+            
+        default:
+            fatalError;
     }
+    
+    if (!mc) {
+        
+        // Each pixel is determined by a single bit
+        plane1 = plane0 = data >> from;
+        sr.colorbits = (data >> (8 - n)) & 1;
+        
+    } else if (sr.mcFlop) {
+        
+        // Each pixel pair is determined by two bits
+        plane1 = ((data & 0xAA) | (data & 0xAA) >> 1) >> from;
+        plane0 = ((data & 0x55) | (data & 0x55) << 1) >> from;
+        sr.colorbits = (data >> (6 - 2 * ((n - 1) / 2))) & 0x3;
+        
+    } else {
+        
+        // The first pixel repeats the color bits of the previous pixel
+        u8 next = u8(data << 1);
+        plane1 = u8((sr.colorbits >> 1) << 7 | ((next & 0xAA) | (next & 0xAA) >> 1) >> 1) >> from;
+        plane0 = u8((sr.colorbits & 1) << 7 | ((next & 0x55) | (next & 0x55) << 1) >> 1) >> from;
+        if (n > 1) sr.colorbits = (next >> (6 - 2 * ((n - 2) / 2))) & 0x3;
+    }
+    
+    sr.data = u8(data << n);
+    if (n & 1) sr.mcFlop = !sr.mcFlop;
+    
+    // Translate the color bits into color indices and depth values
+    u64 range = util::swar::expand(u8(0xFF >> from) & u8(0xFF << (8 - to)));
+    u64 bits1 = util::swar::expand(plane1) & range;
+    u64 bits0 = util::swar::expand(plane0) & range;
+    
+    pixels |=
+    (util::swar::splat(col[0]) & range & ~(bits1 | bits0)) |
+    (util::swar::splat(col[1]) & bits0 & ~bits1) |
+    (util::swar::splat(col[2]) & bits1 & ~bits0) |
+    (util::swar::splat(col[3]) & bits1 & bits0);
+    
+    depths |=
+    (util::swar::splat(DEPTH_FG) & bits1) |
+    (util::swar::splat(DEPTH_BG) & range & ~bits1);
 }
 
 void
@@ -9,6 +9,7 @@
 
 #include "config.h"
 #include "VICII.h"
+#include "Swar.h"
 
 void
 VICII::drawSprites()
@@ -32,8 +33,9 @@ VICII::drawSpritesFastPath()
 {    
     if (VIC_STATS) stats.spriteFastPath++;
     
-    // Prepare for collision detection
-    for (isize i = 0; i < 8; i++) collision[i] = 0;
+    u64 pixels = util::swar::load(idxTexturePtr + bufferoffset);
+    u64 depths = util::swar::load(zBuffer + bufferoffset);
+    u64 coll = 0;
     
     // Iterate through all 8 sprites
     for (isize i = 0; i < 8; i++) {
@@ -47,24 +49,33 @@ VICII::drawSpritesFastPath()
         if (GET_BIT(reg.delayed.sprMC, i)) {
             
             // Draw multicolor sprite
-            drawSpriteNr <true> (i, enable, active);
+            drawSpriteNr <true> (i, enable, active, pixels, depths, coll);
             
         } else {
             
             // Draw monocolor sprite
-            drawSpriteNr <false> (i, enable, active);
+            drawSpriteNr <false> (i, enable, active, pixels, depths, coll);
         }
     }
+    
+    util::swar::store(idxTexturePtr + bufferoffset, pixels);
+    util::swar::store(zBuffer + bufferoffset, depths);
+    util::swar::store(collision, coll);
  
     // Perform collision checks
     checkCollisions();
 }
 
 template <bool multicolor> void
-VICII::drawSpriteNr(isize nr, bool enable, bool active)
+VICII::drawSpriteNr(isize nr, bool enable, bool active,
+                    u64 &pixels, u64 &depths, u64 &coll)
 {
     bool xExp = GET_BIT(reg.delayed.sprExpandX, nr);
-
+    
+    // Color bits of all pixels (bit 7 corresponds to pixel 0)
+    u8 plane1 = 0;
+    u8 plane0 = 0;
+    
     for (isize pixel = 0; pixel < 8; pixel++) {
                 
         /* If a sprite is enabled, activate the shift register if the
@@ -113,23 +124,42 @@ VICII::drawSpriteNr(isize nr, bool enable, bool active)
             // Toggle expansion flipflop for horizontally stretched sprites
             spriteSr[nr].expFlop = !spriteSr[nr].expFlop || !xExp;
             
-            // Draw pixel
-            if (spriteSr[nr].colBits && !config.hideSprites) {
-                
-                // Only draw the pixel if no other sprite pixel has been drawn yet
-                if (!collision[pixel]) {
-                    
-                    u8 color =
-                    spriteSr[nr].colBits == 1 ? reg.delayed.colors[COLREG_SPR_EX1] :
-                    spriteSr[nr].colBits == 2 ? reg.delayed.colors[COLREG_SPR0 + nr] :
-                    reg.delayed.colors[COLREG_SPR_EX2];
-                    
-                    SET_SPRITE_PIXEL(nr, pixel, color);
-                }
-                collision[pixel] |= (1 << nr);
-            }
+            // Record the color bits
+            plane1 |= ((spriteSr[nr].colBits >> 1) & 1) << (7 - pixel);
+            plane0 |= (spriteSr[nr].colBits & 1) << (7 - pixel);
         }
     }
+    
+    // Only proceed if there is something to draw
+    if (!(plane1 | plane0) || config.hideSprites) return;
+    
+    u64 bits1 = util::swar::expand(plane1);
+    u64 bits0 = util::swar::expand(plane0);
+    u64 drawn = bits1 | bits0;
+    
+    /* Only draw pixels that haven't been drawn by another sprite and that are
+     * closer to the view point than the current pixel.
+     */
+    u8 depth = spriteDepth(nr);
+    u64 visible =
+    drawn & ~util::swar::nonZero(coll) &
+    util::swar::greaterEqual(depths, util::swar::splat(depth));
+    
+    if (isVisibleColumn) {
+        
+        u64 colors =
+        (util::swar::splat(reg.delayed.colors[COLREG_SPR_EX1]) & bits0 & ~bits1) |
+        (util::swar::splat(reg.delayed.colors[COLREG_SPR0 + nr]) & bits1 & ~bits0) |
+        (util::swar::splat(reg.delayed.colors[COLREG_SPR_EX2]) & bits1 & bits0);
+        
+        pixels = util::swar::select(visible, colors, pixels);
+    }
+    
+    u64 newDepths = util::swar::splat(depth) | (depths & util::swar::splat(0x10));
+    depths = util::swar::select(visible, newDepths, depths);
+    
+    // Remember the drawn pixels for collision detection
+    coll |= drawn & util::swar::splat(u8(1 << nr));
 }
 
 //
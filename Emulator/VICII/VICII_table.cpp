@@ -9,12 +9,16 @@
 
 #include "config.h"
 #include "VICII.h"
+#include "C64.h"
 
 void
 VICII::updateVicFunctionTable()
 {    
     trace(VIC_DEBUG, "updateVicFunctionTable (dmaDebug: %d)\n", dmaDebug());
     
+    // The DMA debugger is put aside in fast-forward mode
+    bool debug = dmaDebug() && !c64.inFastForwardMode();
+    
     vicfunc[0] = nullptr;
     vicfunc[64] = nullptr;
     vicfunc[65] = nullptr;
@@ -26,7 +30,7 @@ VICII::updateVicFunctionTable()
         case VICII_PAL_6569_R3:
         case VICII_PAL_8565:
             
-            if (dmaDebug()) {
+            if (debug) {
                 for (isize i = 1; i <= 63; i++) {
                     vicfunc[i] = getViciiFunc <PAL_CYCLE | DEBUG_CYCLE> (i);
                 }
@@ -39,7 +43,7 @@ VICII::updateVicFunctionTable()
                         
         case VICII_NTSC_6567_R56A:
             
-            if (dmaDebug()) {
+            if (debug) {
                 for (isize i = 1; i <= 11; i++) {
                     vicfunc[i] = getViciiFunc <PAL_CYCLE | DEBUG_CYCLE> (i);
                 }
@@ -59,7 +63,7 @@ VICII::updateVicFunctionTable()
         case VICII_NTSC_6567:
         case VICII_NTSC_8562:
             
-            if (dmaDebug()) {
+            if (debug) {
                 for (isize i = 1; i <= 65; i++) {
                     vicfunc[i] = getViciiFunc <NTSC_CYCLE | DEBUG_CYCLE> (i);
                 }
@@ -389,7 +389,7 @@
 
 - (u32 *)stableEmuTexture
 {
-    return [self vicii]->stableEmuTexture();
+    return [self vicii]->acquireEmuTexture();
 }
 
 - (NSColor *)color:(NSInteger)nr
@@ -21,7 +21,7 @@
 // Snapshot version number
 #define SNP_MAJOR 4
 #define SNP_MINOR 5
-#define SNP_SUBMINOR 0
+#define SNP_SUBMINOR 3
 
 // Uncomment these settings in a release build
 // #define RELEASEBUILD
@@ -61,6 +61,7 @@ static const int RUN_DEBUG       = 0; // Run loop, component states, timing
 static const int WARP_DEBUG      = 0; // Warp mode
 static const int QUEUE_DEBUG     = 0; // Message queue
 static const int SNP_DEBUG       = 0; // Serializing (snapshots)
+static const int CYCLE_PROFILER  = 0; // Measure host time per component
 
 // CPU
 static const int CPU_DEBUG       = 0; // CPU
@@ -104,6 +105,7 @@ static const int FILE_DEBUG      = 0; // Media files (D64,T64,...)
 // Peripherals
 static const int JOY_DEBUG       = 0; // Joystick
 static const int DRV_DEBUG       = 0; // Floppy drive
+static const int DRV_ON_STEROIDS = 1; // Keep the drives awake all the time
 static const int TAP_DEBUG       = 0; // Datasette
 static const int KBD_DEBUG       = 0; // Keyboard
 static const int PRT_DEBUG       = 0; // Control ports and connected devices